@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "ECS.hpp"
+#include "Hierarchy.hpp"
+#include "SharedExport.hpp"
+#include "System.hpp"
+#include "Types.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+struct Velocity
+{
+    float x = 1.0f;
+    float y = 1.0f;
+};
+
+struct Health
+{
+    int value = 100;
+};
+
+class MoveSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Position>());
+        systemSignature.set(compManager->CompId<Velocity>());
+    }
+
+    void Update(const float deltaTime) override
+    {
+        for(EntityId ent : entities)
+        {
+            auto& pos = compManager->GetComponent<Position>(ent);
+            const auto& vel = compManager->GetComponent<Velocity>(ent);
+            pos.x += vel.x * deltaTime;
+            pos.y += vel.y * deltaTime;
+        }
+    }
+};
+
+template <int N>
+class HealthSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Health>());
+    }
+};
+
+// Same systems for the compile time World, to A/B against ECS
+class StaticMoveSys : public StaticSystem<Position, Velocity>
+{
+public:
+    template <typename World>
+    void Update(World& world, const float deltaTime)
+    {
+        auto& positions = world.template GetComponentPool<Position>();
+        const auto& velocities = std::as_const(world.template GetComponentPool<Velocity>());
+        for(EntityId ent : entities)
+        {
+            auto& pos = positions.GetComponent(ent);
+            const auto& vel = velocities.GetComponent(ent);
+            pos.x += vel.x * deltaTime;
+            pos.y += vel.y * deltaTime;
+        }
+    }
+};
+
+template <int N>
+class StaticHealthSys : public StaticSystem<Health>
+{
+};
+
+using StaticWorld = World<ComponentList<Position, Velocity, Health>,
+                          SystemList<StaticMoveSys, StaticHealthSys<0>, StaticHealthSys<1>,
+                                     StaticHealthSys<2>, StaticHealthSys<3>>>;
+
+void EntityCounts(benchmark::internal::Benchmark* bench)
+{
+    for(int64_t count : {1000, 10000, 100000, 1000000})
+        if(count <= MAX_ENTITY_COUNT)
+            bench->Arg(count);
+}
+
+std::vector<EntityId> CreateEntities(ECS& ecs, const int64_t count)
+{
+    std::vector<EntityId> entities(count);
+    for(auto& ent : entities)
+        ent = ecs.CreateEntity();
+    return entities;
+}
+
+std::vector<EntityId> Shuffled(std::vector<EntityId> entities)
+{
+    std::mt19937 rng(1234);
+    std::shuffle(entities.begin(), entities.end(), rng);
+    return entities;
+}
+
+std::unique_ptr<ECS> MakeWorld(const int64_t count, std::vector<EntityId>& entities)
+{
+    auto ecs = std::make_unique<ECS>();
+    ecs->RegisterComponentPool<Position>();
+    ecs->RegisterComponentPool<Velocity>();
+    ecs->RegisterComponentPool<Health>();
+    entities = CreateEntities(*ecs, count);
+    for(EntityId ent : entities)
+    {
+        ecs->AddComponent<Position>(ent);
+        ecs->AddComponent<Velocity>(ent);
+    }
+    return ecs;
+}
+
+std::unique_ptr<StaticWorld> MakeStaticWorld(const int64_t count, std::vector<EntityId>& entities)
+{
+    auto world = std::make_unique<StaticWorld>();
+    entities.resize(count);
+    for(auto& ent : entities)
+    {
+        ent = world->CreateEntity();
+        world->AddComponent<Position>(ent);
+        world->AddComponent<Velocity>(ent);
+    }
+    return world;
+}
+
+void SetCounters(benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["entities"] = state.range(0);
+}
+
+} // namespace
+
+static void BM_CreateDestroyEntities(benchmark::State& state)
+{
+    ECS ecs;
+    std::vector<EntityId> entities(state.range(0));
+    for(auto _ : state)
+    {
+        for(auto& ent : entities)
+            ent = ecs.CreateEntity();
+        for(EntityId ent : entities)
+            ecs.DestroyEntity(ent);
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_CreateDestroyEntities)->Apply(EntityCounts);
+
+static void BM_AddRemoveComponents(benchmark::State& state)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Health>();
+    auto entities = CreateEntities(ecs, state.range(0));
+    for(auto _ : state)
+    {
+        for(EntityId ent : entities)
+            ecs.AddComponent<Health>(ent);
+        for(EntityId ent : entities)
+            ecs.DeleteComponent<Health>(ent);
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_AddRemoveComponents)->Apply(EntityCounts);
+
+static void BM_AddRemoveComponentsWithSystems(benchmark::State& state)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Health>();
+    ecs.RegisterSystem<HealthSys<0>>();
+    ecs.RegisterSystem<HealthSys<1>>();
+    ecs.RegisterSystem<HealthSys<2>>();
+    ecs.RegisterSystem<HealthSys<3>>();
+    auto entities = CreateEntities(ecs, state.range(0));
+    for(auto _ : state)
+    {
+        for(EntityId ent : entities)
+            ecs.AddComponent<Health>(ent);
+        for(EntityId ent : entities)
+            ecs.DeleteComponent<Health>(ent);
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_AddRemoveComponentsWithSystems)->Apply(EntityCounts);
+
+static void BM_DisableEnableComponents(benchmark::State& state)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Health>();
+    ecs.RegisterSystem<HealthSys<0>>();
+    ecs.RegisterSystem<HealthSys<1>>();
+    ecs.RegisterSystem<HealthSys<2>>();
+    ecs.RegisterSystem<HealthSys<3>>();
+    auto entities = CreateEntities(ecs, state.range(0));
+    for(EntityId ent : entities)
+        ecs.AddComponent<Health>(ent);
+    for(auto _ : state)
+    {
+        for(EntityId ent : entities)
+            ecs.Disable<Health>(ent);
+        for(EntityId ent : entities)
+            ecs.Enable<Health>(ent);
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_DisableEnableComponents)->Apply(EntityCounts);
+
+static void BM_PoolIterationHalfDisabled(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    for(size_t i = 0; i < entities.size(); i += 2)
+        ecs->Disable<Position>(entities[i]);
+    auto& pool = ecs->GetComponentPool<Position>();
+    for(auto _ : state)
+        pool.ForEach([](EntityId, Position& pos){ pos.x += 1.0f; });
+    SetCounters(state);
+}
+BENCHMARK(BM_PoolIterationHalfDisabled)->Apply(EntityCounts);
+
+static void BM_StaticAddRemoveComponentsWithSystems(benchmark::State& state)
+{
+    auto world = std::make_unique<StaticWorld>();
+    std::vector<EntityId> entities(state.range(0));
+    for(auto& ent : entities)
+        ent = world->CreateEntity();
+    for(auto _ : state)
+    {
+        for(EntityId ent : entities)
+            world->AddComponent<Health>(ent);
+        for(EntityId ent : entities)
+            world->DeleteComponent<Health>(ent);
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_StaticAddRemoveComponentsWithSystems)->Apply(EntityCounts);
+
+static void BM_SpawnWithAddComponent(benchmark::State& state)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Velocity>();
+    ecs.RegisterComponentPool<Health>();
+    ecs.RegisterSystem<MoveSys>();
+    ecs.RegisterSystem<HealthSys<0>>();
+    std::vector<EntityId> entities(state.range(0));
+    for(auto _ : state)
+    {
+        for(auto& ent : entities)
+        {
+            ent = ecs.CreateEntity();
+            ecs.AddComponent<Position>(ent);
+            ecs.AddComponent<Velocity>(ent);
+            ecs.AddComponent<Health>(ent);
+        }
+        state.PauseTiming();
+        ecs.DestroyEntities(entities);
+        state.ResumeTiming();
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_SpawnWithAddComponent)->Apply(EntityCounts);
+
+static void BM_SpawnWithPrefab(benchmark::State& state)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Velocity>();
+    ecs.RegisterComponentPool<Health>();
+    ecs.RegisterSystem<MoveSys>();
+    ecs.RegisterSystem<HealthSys<0>>();
+    const auto prefab = ecs.CreatePrefab(Position{}, Velocity{}, Health{});
+    for(auto _ : state)
+    {
+        auto entities = ecs.Instantiate(prefab, state.range(0));
+        state.PauseTiming();
+        ecs.DestroyEntities(entities);
+        state.ResumeTiming();
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_SpawnWithPrefab)->Apply(EntityCounts);
+
+static void BM_GetComponentSequential(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    for(auto _ : state)
+        for(EntityId ent : entities)
+            benchmark::DoNotOptimize(ecs->GetComponent<Position>(ent));
+    SetCounters(state);
+}
+BENCHMARK(BM_GetComponentSequential)->Apply(EntityCounts);
+
+static void BM_GetComponentRandom(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    entities = Shuffled(entities);
+    for(auto _ : state)
+        for(EntityId ent : entities)
+            benchmark::DoNotOptimize(ecs->GetComponent<Position>(ent));
+    SetCounters(state);
+}
+BENCHMARK(BM_GetComponentRandom)->Apply(EntityCounts);
+
+static void BM_TryGetComponentSequential(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    for(auto _ : state)
+        for(EntityId ent : entities)
+            benchmark::DoNotOptimize(ecs->TryGetComponent<Position>(ent));
+    SetCounters(state);
+}
+BENCHMARK(BM_TryGetComponentSequential)->Apply(EntityCounts);
+
+static void BM_TryGetComponentMissing(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    for(auto _ : state)
+        for(EntityId ent : entities)
+            benchmark::DoNotOptimize(ecs->TryGetComponent<Health>(ent));
+    SetCounters(state);
+}
+BENCHMARK(BM_TryGetComponentMissing)->Apply(EntityCounts);
+
+static void BM_TryGetComponentRandom(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    entities = Shuffled(entities);
+    for(auto _ : state)
+        for(EntityId ent : entities)
+            benchmark::DoNotOptimize(ecs->TryGetComponent<Position>(ent));
+    SetCounters(state);
+}
+BENCHMARK(BM_TryGetComponentRandom)->Apply(EntityCounts);
+
+static void BM_SystemIteration(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    ecs->RegisterSystem<MoveSys>();
+    for(auto _ : state)
+        ecs->UpdateSystems(0.016f);
+    SetCounters(state);
+}
+BENCHMARK(BM_SystemIteration)->Apply(EntityCounts);
+
+static void BM_StaticSystemIteration(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto world = MakeStaticWorld(state.range(0), entities);
+    for(auto _ : state)
+        world->UpdateSystems(0.016f);
+    SetCounters(state);
+}
+BENCHMARK(BM_StaticSystemIteration)->Apply(EntityCounts);
+
+static void BM_PoolIteration(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    auto& pool = ecs->GetComponentPool<Position>();
+    for(auto _ : state)
+        pool.ForEach([](EntityId, Position& pos){ pos.x += 1.0f; });
+    SetCounters(state);
+}
+BENCHMARK(BM_PoolIteration)->Apply(EntityCounts);
+
+// Chains hung off random earlier nodes, then random reparents. Items per second
+// should only drift with tree depth, an edit costing the whole array shows up
+// as a drop proportional to the entity count.
+static void BM_HierarchyBuildReparent(benchmark::State& state)
+{
+    const EntityId count = state.range(0);
+    for(auto _ : state)
+    {
+        std::mt19937 rng(7);
+        Hierarchy hierarchy;
+        for(EntityId id = 1; id < count; id++)
+            hierarchy.SetParent(id, id % 64 != 0 ? id - 1 : rng() % id);
+        for(EntityId i = 0; i < count / 25; i++)
+        {
+            const EntityId child = 1 + rng() % (count - 1);
+            hierarchy.SetParent(child, rng() % child);
+        }
+        benchmark::DoNotOptimize(hierarchy.Nodes().data());
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_HierarchyBuildReparent)->Apply(EntityCounts);
+
+static void BM_SharedMemoryPublish(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    SharedMemoryExporter exporter;
+    if(!exporter.Export<Position>(*ecs, "/ecs_bench_" + std::to_string(getpid())))
+    {
+        state.SkipWithError("shm_open failed");
+        return;
+    }
+    for(auto _ : state)
+        exporter.Publish(*ecs);
+    SetCounters(state);
+}
+BENCHMARK(BM_SharedMemoryPublish)->Apply(EntityCounts);
+
+static void BM_CloneWorld(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto ecs = MakeWorld(state.range(0), entities);
+    ecs->RegisterSystem<MoveSys>();
+    for(auto _ : state)
+        benchmark::DoNotOptimize(ecs->Clone());
+    SetCounters(state);
+}
+BENCHMARK(BM_CloneWorld)->Apply(EntityCounts);
+
+static void BM_ConstructECS(benchmark::State& state)
+{
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::make_unique<ECS>());
+}
+BENCHMARK(BM_ConstructECS);
+
+static void BM_RegisterComponentPool(benchmark::State& state)
+{
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        auto ecs = std::make_unique<ECS>();
+        state.ResumeTiming();
+        ecs->RegisterComponentPool<Position>();
+        ecs->RegisterComponentPool<Velocity>();
+        ecs->RegisterComponentPool<Health>();
+        state.PauseTiming();
+        ecs.reset();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_RegisterComponentPool);
+
+static void BM_RegisterSystem(benchmark::State& state)
+{
+    std::vector<EntityId> entities;
+    auto world = MakeWorld(state.range(0), entities);
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        auto ecs = world->Clone();
+        state.ResumeTiming();
+        ecs->RegisterSystem<MoveSys>();
+        state.PauseTiming();
+        ecs.reset();
+        state.ResumeTiming();
+    }
+    SetCounters(state);
+}
+BENCHMARK(BM_RegisterSystem)->Apply(EntityCounts);
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Summarise and compare frame telemetry written by `App --telemetry FILE`.
+
+    CompareTelemetry.py run.tsv                  percentiles of one run
+    CompareTelemetry.py baseline.tsv new.tsv     compare, exit 1 on regression
+
+A metric regresses when its p99 grows by more than --threshold percent and by
+more than --min-delta in absolute terms, the block-bootstrap confidence interval
+of that growth excludes zero and a one-sided Mann-Whitney U test says the new
+frames are slower. Only the standard library is used so it runs on CI machines
+without numpy.
+"""
+import argparse
+import math
+import random
+import sys
+
+PERCENTILES = (50, 90, 99)
+
+
+def load(path, skip):
+    with open(path) as file:
+        header = file.readline().split()
+        columns = {name: [] for name in header[1:]}
+        for line in file:
+            values = line.split()
+            if len(values) != len(header):
+                continue
+            for name, value in zip(header[1:], values[1:]):
+                columns[name].append(float(value))
+    return {name: values[skip:] for name, values in columns.items()}
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return float("nan")
+    rank = p / 100.0 * (len(sorted_values) - 1)
+    low = math.floor(rank)
+    high = min(low + 1, len(sorted_values) - 1)
+    return sorted_values[low] + (sorted_values[high] - sorted_values[low]) * (rank - low)
+
+
+def mann_whitney_greater(baseline, candidate):
+    """One-sided p-value for candidate being stochastically larger than baseline."""
+    n1, n2 = len(baseline), len(candidate)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    merged = sorted([(value, 0) for value in baseline] + [(value, 1) for value in candidate])
+    ranks = [0.0] * len(merged)
+    tie_term = 0.0
+    i = 0
+    while i < len(merged):
+        j = i
+        while j + 1 < len(merged) and merged[j + 1][0] == merged[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1.0
+        ties = j - i + 1
+        tie_term += ties ** 3 - ties
+        i = j + 1
+
+    rank_sum = sum(rank for rank, (_, group) in zip(ranks, merged) if group == 1)
+    u = rank_sum - n2 * (n2 + 1) / 2.0
+    n = n1 + n2
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0.0:
+        return 1.0
+    z = (u - n1 * n2 / 2.0 - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def block_resample(values, block, rng):
+    # Consecutive frames are correlated (GC, thermal, vsync), so resample whole blocks.
+    out = []
+    while len(out) < len(values):
+        start = rng.randrange(max(1, len(values) - block + 1))
+        out.extend(values[start:start + block])
+    return out[:len(values)]
+
+
+def bootstrap_p99_delta(baseline, candidate, resamples, block, rng):
+    deltas = []
+    for _ in range(resamples):
+        base = percentile(sorted(block_resample(baseline, block, rng)), 99)
+        cand = percentile(sorted(block_resample(candidate, block, rng)), 99)
+        deltas.append((cand - base) / base * 100.0 if base > 0 else 0.0)
+    deltas.sort()
+    return percentile(deltas, 2.5), percentile(deltas, 97.5)
+
+
+def summarise(path, run):
+    print(f"{path}: {len(next(iter(run.values()), []))} frames")
+    print(f"{'metric':<14}" + "".join(f"{'p' + str(p):>10}" for p in PERCENTILES) + f"{'max':>10}{'mean':>10}")
+    for name, values in run.items():
+        ordered = sorted(values)
+        mean = sum(values) / len(values) if values else float("nan")
+        print(f"{name:<14}" + "".join(f"{percentile(ordered, p):>10.3f}" for p in PERCENTILES)
+              + f"{ordered[-1] if ordered else float('nan'):>10.3f}{mean:>10.3f}")
+
+
+def compare(baseline, candidate, args):
+    rng = random.Random(args.seed)
+    regressions = []
+    print(f"{'metric':<14}{'base p50':>10}{'new p50':>10}{'base p99':>10}{'new p99':>10}"
+          f"{'p99 %':>9}{'95% CI':>18}{'U test p':>10}")
+    for name in baseline:
+        if name not in candidate or not baseline[name] or not candidate[name]:
+            continue
+        base, cand = sorted(baseline[name]), sorted(candidate[name])
+        base_p99, cand_p99 = percentile(base, 99), percentile(cand, 99)
+        delta = (cand_p99 - base_p99) / base_p99 * 100.0 if base_p99 > 0 else 0.0
+        low, high = bootstrap_p99_delta(baseline[name], candidate[name], args.resamples, args.block, rng)
+        p_value = mann_whitney_greater(baseline[name], candidate[name])
+
+        regressed = (delta > args.threshold and cand_p99 - base_p99 > args.min_delta
+                     and low > 0.0 and p_value < args.alpha)
+        if regressed:
+            regressions.append(name)
+        print(f"{name:<14}{percentile(base, 50):>10.3f}{percentile(cand, 50):>10.3f}{base_p99:>10.3f}{cand_p99:>10.3f}"
+              f"{delta:>+8.1f}%{f'[{low:+.1f}, {high:+.1f}]':>18}{p_value:>10.4f}"
+              + ("  REGRESSION" if regressed else ""))
+
+    if regressions:
+        print(f"\np99 regressed: {', '.join(regressions)}")
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("candidate", nargs="?")
+    parser.add_argument("--skip", type=int, default=2, help="warmup frames to drop from each run")
+    parser.add_argument("--threshold", type=float, default=5.0, help="p99 growth in percent treated as a regression")
+    parser.add_argument("--min-delta", type=float, default=0.05,
+                        help="smallest absolute p99 growth that counts, filters out sub-timer-resolution noise")
+    parser.add_argument("--alpha", type=float, default=0.01, help="significance level")
+    parser.add_argument("--resamples", type=int, default=1000, help="bootstrap resamples")
+    parser.add_argument("--block", type=int, default=32, help="bootstrap block length in frames")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.skip)
+    if args.candidate is None:
+        summarise(args.baseline, baseline)
+        return 0
+
+    candidate = load(args.candidate, args.skip)
+    summarise(args.baseline, baseline)
+    print()
+    summarise(args.candidate, candidate)
+    print()
+    return compare(baseline, candidate, args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
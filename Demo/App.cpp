@@ -1,16 +1,26 @@
 #include "App.hpp"
-#include "SDL3_image/SDL_image.h"
-#include "Utils.hpp"
+#include "Components.hpp"
+#include "Systems.hpp"
 #include <SDL3/SDL.h>
 #include <chrono>
+#include <random>
 #include <string>
+#include <thread>
 
 
-App::App()
+App::App(const AppConfig& config) : config(config)
 {
+    SDL_WindowFlags windowFlags = SDL_WINDOW_RESIZABLE;
+    if (config.headless)
+    {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        windowFlags = SDL_WINDOW_HIDDEN;
+    }
+
 	if (!SDL_Init(SDL_INIT_VIDEO))
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s", SDL_GetError());
-	if (!SDL_CreateWindowAndRenderer("Hello SDL", 320, 240, SDL_WINDOW_RESIZABLE, &window, &renderer))
+	if (!SDL_CreateWindowAndRenderer("Hello SDL", 1280, 720, windowFlags, &window, &renderer))
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create window and renderer: %s", SDL_GetError()); 
 
     Initialise();
@@ -26,41 +36,206 @@ App::~App()
 
 void App::Initialise()
 {
-    std::string path = ART_PATH;
-	path += "gandalf.jpg";
-    texture = LoadTextureFromFile(renderer, path);
+    assets = std::make_unique<AssetManager>(renderer);
+    spriteRenderer = std::make_unique<SpriteRenderer>(renderer);
+
+    ecs.RegisterComponentPool<Transform>(config.sprites);
+    ecs.RegisterComponentPool<Velocity>(config.sprites);
+    ecs.RegisterComponentPool<Sprite>(config.sprites);
+    ecs.RegisterComponentPool<TextureHandle>(config.sprites);
+
+    int width = 0, height = 0;
+    SDL_GetRenderOutputSize(renderer, &width, &height);
+    ecs.SetResource<Viewport>(static_cast<float>(width), static_cast<float>(height));
+    ecs.SetResource<RenderSnapshot>();
+    ecs.RegisterEvent<KeyInput>();
+    ecs.RegisterEvent<PointerInput>();
+    ecs.RegisterEvent<ActionEvent>();
+
+    ecs.RegisterSystem<MovementSystem>();
+    ecs.RegisterSystem<ScatterSystem>();
+    ecs.RegisterSystem<TextureBindSystem>(assets.get());
+    ecs.RegisterSystem<SpriteExtractSystem>();
+    SpawnSprites();
+
+    // Benchmark runs should not depend on how fast the decode threads happen to be
+    if (config.headless)
+        while (assets->Pending() > 0)
+            if (assets->Upload(config.uploadBudgetNs) == 0)
+                std::this_thread::yield();
+
+    // The first frame draws the spawned scene, in pipelined mode later frames stay one update behind
+    Extract();
+    if (config.pipelined)
+        worker = std::thread(&App::UpdateWorker, this);
+}
+
+void App::SpawnSprites()
+{
+    const Viewport& viewport = ecs.GetResource<Viewport>();
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    const TextureHandle gandalf = assets->Load(std::string(ART_PATH) + "gandalf.jpg");
+
+    for(uint32_t i = 0; i < config.sprites; i++)
+    {
+        const EntityId entity = ecs.CreateEntity();
+        ecs.AddComponent<Transform>(entity, unit(rng) * viewport.width, unit(rng) * viewport.height,
+                                    unit(rng) * 6.28f, 0.5f + unit(rng));
+        ecs.AddComponent<Velocity>(entity, (unit(rng) - 0.5f) * 200.f, (unit(rng) - 0.5f) * 200.f,
+                                   (unit(rng) - 0.5f) * 4.f);
+
+        // Quarters of the same image on a few layers, still a single batch
+        ecs.AddComponent<TextureHandle>(entity, gandalf.asset,
+                                        SDL_FRect{0.5f * (i % 2), 0.5f * ((i / 2) % 2), 0.5f, 0.5f});
+        Sprite& sprite = ecs.AddComponent<Sprite>(entity);
+        sprite.color = {unit(rng), unit(rng), unit(rng), 1.f};
+        sprite.layer = i % 4;
+    }
 }
 
 void App::Clean()
 { 
-	SDL_DestroyTexture(texture);
+    if (worker.joinable())
+    {
+        {
+            std::lock_guard lock(workerMutex);
+            stopWorker = true;
+        }
+        workerWake.notify_all();
+        worker.join();
+    }
+    spriteRenderer.reset();
+    assets.reset();
 }
 
+// Drains every queued SDL event into the ECS event bus, systems read them in batches during Update
 bool App::ProcessInputs()
 {
     bool isQuiting = false;
-    SDL_PollEvent(&event);
-	
-    if (event.type == SDL_EVENT_QUIT)
-		isQuiting = true;
+    auto& keys = ecs.GetEvents<KeyInput>();
+    auto& pointers = ecs.GetEvents<PointerInput>();
+    auto& actions = ecs.GetEvents<ActionEvent>();
 
-    return isQuiting;
+    while (SDL_PollEvent(&event))
+    {
+        switch (event.type)
+        {
+        case SDL_EVENT_QUIT:
+            isQuiting = true;
+            break;
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+        {
+            keys.Send({event.key.scancode, event.key.down, event.key.repeat});
+            const Action* action = inputMap.Key(event.key.scancode);
+            if (action && event.key.down && !event.key.repeat)
+                actions.Send({*action});
+            break;
+        }
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+        {
+            pointers.Send({event.button.x, event.button.y, event.button.button, event.button.down});
+            const Action* action = inputMap.Button(event.button.button);
+            if (action && event.button.down)
+                actions.Send({*action, event.button.x, event.button.y});
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    quitReader.Read(actions).ForEach([&](const ActionEvent& action)
+    {
+        if (action.action == Action::Quit)
+            isQuiting = true;
+    });
 
+    return isQuiting;
 }
 
-void App::Update()
+// Main thread part of an update, nothing else may touch the ECS while it runs
+void App::PrepareUpdate()
 {
     {
         auto now = std::chrono::high_resolution_clock::now();
         deltaTime = std::chrono::duration_cast<std::chrono::nanoseconds>(now - prevFrameStart).count() / 1.e9;
         prevFrameStart = now;
     } 
+    if (config.fixedDeltaTime > 0.f)
+        deltaTime = config.fixedDeltaTime;
+
+    int width = 0, height = 0;
+    SDL_GetRenderOutputSize(renderer, &width, &height);
+    ecs.GetResource<Viewport>() = {static_cast<float>(width), static_cast<float>(height)};
+    assets->Upload(config.uploadBudgetNs);
+}
+
+void App::Update()
+{
+    PrepareUpdate();
+    ecs.Tick(static_cast<float>(deltaTime));
+}
+
+void App::Extract()
+{
+    ecs.RenderSystems();
+    std::swap(drawnSnapshot, ecs.GetResource<RenderSnapshot>());
+}
+
+void App::BeginUpdate()
+{
+    PrepareUpdate();
+    {
+        std::lock_guard lock(workerMutex);
+        updateRequested = true;
+        updateDone = false;
+    }
+    workerWake.notify_all();
+}
+
+void App::EndUpdate()
+{
+    {
+        std::unique_lock lock(workerMutex);
+        workerWake.wait(lock, [this]{ return updateDone; });
+    }
+    std::swap(drawnSnapshot, ecs.GetResource<RenderSnapshot>());
+}
+
+void App::UpdateWorker()
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock(workerMutex);
+            workerWake.wait(lock, [this]{ return updateRequested || stopWorker; });
+            if (stopWorker)
+                return;
+            updateRequested = false;
+        }
+
+        ecs.Tick(static_cast<float>(deltaTime));
+        ecs.RenderSystems();
+
+        {
+            std::lock_guard lock(workerMutex);
+            updateDone = true;
+        }
+        workerWake.notify_all();
+    }
 }
 
 void App::Render()
 {
     SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0x00);
 	SDL_RenderClear(renderer);
-	SDL_RenderTexture(renderer, texture, NULL, NULL);
+    spriteRenderer->Draw(drawnSnapshot);
+}
+
+void App::Present()
+{
 	SDL_RenderPresent(renderer);
 }
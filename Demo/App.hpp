@@ -1,24 +1,70 @@
 #pragma once
 #include "SDL3/SDL_render.h"
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "AssetManager.hpp"
+#include "Components.hpp"
+#include "ECS.hpp"
+#include "Input.hpp"
+#include "SpriteRenderer.hpp"
 
+struct AppConfig
+{
+    uint32_t sprites = 1000;
+    uint32_t seed = 1;
+    uint64_t uploadBudgetNs = 2'000'000; // per frame
+    bool headless = false; // offscreen video driver and software renderer, no display needed
+    bool pipelined = false; // simulate frame N+1 on a worker while frame N is drawn
+    uint32_t frames = 0; // 0 runs until the window is closed
+    float fixedDeltaTime = 0.f; // 0 uses wall clock time
+};
+
+// A frame is Update (simulate), Extract (copy the draw list out of the ECS), Render
+// and Present. Pipelined, BeginUpdate() starts Update + Extract of the next frame
+// on a worker, Render() and Present() draw the previous snapshot meanwhile and
+// EndUpdate() waits for the worker and swaps the snapshots.
 class App
 {
 public:
-    App();
+    App(const AppConfig& config = {});
 
-    void Update();
     bool ProcessInputs();
+    void Update();
+    void Extract();
+    void BeginUpdate();
+    void EndUpdate();
     void Render();
+    void Present();
     ~App();
 private:
     void Initialise();
+    void SpawnSprites();
     void Clean();
+    void PrepareUpdate();
+    void UpdateWorker();
 
-	SDL_Texture* texture;
 	SDL_Window* window;
 	SDL_Renderer* renderer;
 	SDL_Event event;
+    InputMap inputMap;
+    EventReader<ActionEvent> quitReader;
+
+    AppConfig config;
+    std::unique_ptr<AssetManager> assets;
+    std::unique_ptr<SpriteRenderer> spriteRenderer;
+    ECS ecs;
+    RenderSnapshot drawnSnapshot; // the ECS extracts into its RenderSnapshot resource
+
+    std::thread worker;
+    std::mutex workerMutex;
+    std::condition_variable workerWake;
+    bool updateRequested = false;
+    bool updateDone = false;
+    bool stopWorker = false;
 
     double deltaTime;
     std::chrono::time_point<std::chrono::high_resolution_clock> prevFrameStart{std::chrono::high_resolution_clock::now()};
@@ -0,0 +1,191 @@
+#include "AssetManager.hpp"
+#include <SDL3/SDL.h>
+#include "SDL3_image/SDL_image.h"
+#include <algorithm>
+#include <vector>
+#include "Clock.hpp"
+
+namespace
+{
+    // Empty border around packed images so linear filtering does not bleed neighbours in
+    constexpr int ATLAS_PADDING = 1;
+}
+
+AssetManager::AssetManager(SDL_Renderer* renderer, uint32_t threads, const int atlasSize, const int maxPackedSize)
+    : renderer(renderer), atlasSize(atlasSize), maxPackedSize(std::min(maxPackedSize, atlasSize - 2 * ATLAS_PADDING))
+{
+    if(threads == 0)
+        threads = std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+
+    for(uint32_t i = 0; i < threads; i++)
+        workers.emplace_back(&AssetManager::Work, this);
+}
+
+AssetManager::~AssetManager()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    wakeWorkers.notify_all();
+    for(auto& worker : workers)
+        worker.join();
+
+    for(auto& done : decoded)
+        SDL_DestroySurface(done.surface);
+    for(auto& atlas : atlases)
+        SDL_DestroyTexture(atlas.texture);
+    for(auto* texture : ownTextures)
+        SDL_DestroyTexture(texture);
+}
+
+TextureHandle AssetManager::Load(const std::string& path)
+{
+    const auto found = pathToAsset.find(path);
+    if(found != pathToAsset.end())
+        return {found->second};
+
+    const AssetId asset = regions.size();
+    regions.emplace_back();
+    pathToAsset.emplace(path, asset);
+    pending++;
+    {
+        std::lock_guard lock(mutex);
+        jobs.push_back({asset, path});
+    }
+    wakeWorkers.notify_one();
+    return {asset};
+}
+
+bool AssetManager::IsReady(const TextureHandle handle) const
+{
+    return handle.asset < regions.size() && regions[handle.asset].state == AssetState::Ready;
+}
+
+void AssetManager::Work()
+{
+    while(true)
+    {
+        Job job;
+        {
+            std::unique_lock lock(mutex);
+            wakeWorkers.wait(lock, [this]{ return stopping || !jobs.empty(); });
+            if(stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        // Decoding and conversion touch no renderer state, so they are safe off the main thread
+        SDL_Surface* surface = IMG_Load(job.path.c_str());
+        if(surface && surface->format != SDL_PIXELFORMAT_RGBA32)
+        {
+            SDL_Surface* converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+            SDL_DestroySurface(surface);
+            surface = converted;
+        }
+        if(!surface)
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load %s: %s", job.path.c_str(), SDL_GetError());
+
+        std::lock_guard lock(mutex);
+        decoded.push_back({job.asset, surface});
+    }
+}
+
+uint32_t AssetManager::Upload(const uint64_t budgetNs)
+{
+    const uint64_t start = ReadNanoseconds();
+    uint32_t uploaded = 0;
+    while(uploaded == 0 || ReadNanoseconds() - start < budgetNs)
+    {
+        Decoded done;
+        {
+            std::lock_guard lock(mutex);
+            if(decoded.empty())
+                break;
+            done = decoded.front();
+            decoded.pop_front();
+        }
+
+        Place(done.asset, done.surface);
+        SDL_DestroySurface(done.surface);
+        pending--;
+        uploaded++;
+    }
+    return uploaded;
+}
+
+void AssetManager::Place(const AssetId asset, SDL_Surface* surface)
+{
+    TextureRegion& region = regions[asset];
+    region.state = AssetState::Failed;
+    if(!surface)
+        return;
+
+    region.width = surface->w;
+    region.height = surface->h;
+
+    if(surface->w > maxPackedSize || surface->h > maxPackedSize)
+    {
+        region.texture = SDL_CreateTextureFromSurface(renderer, surface);
+        if(!region.texture)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create texture from surface: %s", SDL_GetError());
+            return;
+        }
+        ownTextures.push_back(region.texture);
+        region.uv = {0.f, 0.f, 1.f, 1.f};
+        region.state = AssetState::Ready;
+        return;
+    }
+
+    SDL_Rect rect;
+    if(atlases.empty() || !Pack(atlases.back(), surface->w, surface->h, rect))
+    {
+        Atlas atlas;
+        atlas.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, atlasSize, atlasSize);
+        if(!atlas.texture)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create atlas texture: %s", SDL_GetError());
+            return;
+        }
+        // Texture memory starts undefined, clear it so the padding really is empty
+        const std::vector<uint32_t> clear(static_cast<size_t>(atlasSize) * atlasSize, 0u);
+        SDL_UpdateTexture(atlas.texture, nullptr, clear.data(), atlasSize * sizeof(uint32_t));
+        atlases.push_back(atlas);
+        Pack(atlases.back(), surface->w, surface->h, rect);
+    }
+
+    if(!SDL_UpdateTexture(atlases.back().texture, &rect, surface->pixels, surface->pitch))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't upload into atlas: %s", SDL_GetError());
+        return;
+    }
+
+    const float size = atlasSize;
+    region.texture = atlases.back().texture;
+    region.uv = {rect.x / size, rect.y / size, rect.w / size, rect.h / size};
+    region.state = AssetState::Ready;
+}
+
+// Shelf packing, images fill a row left to right and a new shelf starts below the tallest one
+bool AssetManager::Pack(Atlas& atlas, const int width, const int height, SDL_Rect& rect) const
+{
+    const int paddedWidth = width + 2 * ATLAS_PADDING;
+    const int paddedHeight = height + 2 * ATLAS_PADDING;
+
+    if(atlas.shelfX + paddedWidth > atlasSize)
+    {
+        atlas.shelfY += atlas.shelfHeight;
+        atlas.shelfX = 0;
+        atlas.shelfHeight = 0;
+    }
+    if(atlas.shelfY + paddedHeight > atlasSize)
+        return false;
+
+    rect = {atlas.shelfX + ATLAS_PADDING, atlas.shelfY + ATLAS_PADDING, width, height};
+    atlas.shelfX += paddedWidth;
+    atlas.shelfHeight = std::max(atlas.shelfHeight, paddedHeight);
+    return true;
+}
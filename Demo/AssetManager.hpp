@@ -0,0 +1,106 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "SDL3/SDL_render.h"
+#include "SDL3/SDL_surface.h"
+#include "Types.hpp"
+
+using AssetId = uint32_t;
+
+// Component, the image a Sprite shows once it is loaded. uv selects part of the image.
+struct TextureHandle
+{
+    AssetId asset = INVALID_ID;
+    SDL_FRect uv{0.f, 0.f, 1.f, 1.f};
+};
+
+enum class AssetState
+{
+    Loading,
+    Ready,
+    Failed
+};
+
+struct TextureRegion
+{
+    AssetState state = AssetState::Loading;
+    SDL_Texture* texture = nullptr;
+    SDL_FRect uv{0.f, 0.f, 1.f, 1.f}; // normalised rect inside texture
+    float width = 0.f;
+    float height = 0.f;
+};
+
+// Decodes images on worker threads, the main thread uploads finished ones in
+// Upload() within a time budget. Images up to maxPackedSize are packed into
+// shared atlas textures so sprites using them stay in one draw batch.
+class AssetManager
+{
+public:
+    AssetManager(SDL_Renderer* renderer,
+                 uint32_t threads = 0,
+                 int atlasSize = 2048,
+                 int maxPackedSize = 512);
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+    ~AssetManager();
+
+    // Never blocks, loading the same path twice returns the same asset
+    TextureHandle Load(const std::string& path);
+
+    // Main thread only, returns the number of images uploaded. At least one
+    // pending image is uploaded per call so loading always makes progress.
+    uint32_t Upload(const uint64_t budgetNs);
+
+    const TextureRegion& Get(const AssetId asset) const { return regions[asset]; }
+    bool IsReady(const TextureHandle handle) const;
+    uint32_t Pending() const { return pending; }
+    uint32_t AtlasCount() const { return atlases.size(); }
+
+private:
+    struct Job
+    {
+        AssetId asset;
+        std::string path;
+    };
+
+    struct Decoded
+    {
+        AssetId asset;
+        SDL_Surface* surface;
+    };
+
+    struct Atlas
+    {
+        SDL_Texture* texture = nullptr;
+        int shelfX = 0;
+        int shelfY = 0;
+        int shelfHeight = 0;
+    };
+
+    void Work();
+    void Place(const AssetId asset, SDL_Surface* surface);
+    bool Pack(Atlas& atlas, const int width, const int height, SDL_Rect& rect) const;
+
+    SDL_Renderer* renderer;
+    const int atlasSize;
+    const int maxPackedSize;
+
+    std::vector<TextureRegion> regions;
+    std::unordered_map<std::string, AssetId> pathToAsset;
+    std::vector<Atlas> atlases;
+    std::vector<SDL_Texture*> ownTextures;
+    uint32_t pending = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::deque<Job> jobs;
+    std::deque<Decoded> decoded;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
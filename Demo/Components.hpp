@@ -0,0 +1,58 @@
+#pragma once
+#include "SDL3/SDL_rect.h"
+#include "SDL3/SDL_pixels.h"
+#include "SDL3/SDL_render.h"
+#include <cstdint>
+#include <vector>
+
+struct Transform
+{
+    float x = 0.f;
+    float y = 0.f;
+    float rotation = 0.f; // radians
+    float scale = 1.f;
+};
+
+struct Velocity
+{
+    float x = 0.f;
+    float y = 0.f;
+    float angular = 0.f;
+};
+
+struct Sprite
+{
+    SDL_Texture* texture = nullptr;
+    SDL_FRect uv{0.f, 0.f, 1.f, 1.f}; // normalised source rect
+    float width = 32.f;
+    float height = 32.f;
+    SDL_FColor color{1.f, 1.f, 1.f, 1.f};
+    int32_t layer = 0;
+};
+
+// World resource, size of the render target in pixels
+struct Viewport
+{
+    float width = 0.f;
+    float height = 0.f;
+};
+
+// Everything needed to draw one sprite, copied out of the ECS during extract
+struct SpriteInstance
+{
+    SDL_Texture* texture;
+    SDL_FRect uv;
+    SDL_FColor color;
+    float x;
+    float y;
+    float rotation;
+    float halfWidth;
+    float halfHeight;
+};
+
+// World resource, draw list in submission order. The renderer only ever reads
+// a snapshot, so it can draw one frame while the ECS simulates the next.
+struct RenderSnapshot
+{
+    std::vector<SpriteInstance> sprites;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <unordered_map>
+
+// Raw input, one ECS event per SDL event
+struct KeyInput
+{
+    SDL_Scancode scancode;
+    bool down;
+    bool repeat;
+};
+
+struct PointerInput
+{
+    float x;
+    float y;
+    uint8_t button;
+    bool down;
+};
+
+enum class Action : uint8_t
+{
+    Quit,
+    TogglePause,
+    Scatter
+};
+
+// Raw input translated through InputMap, what gameplay systems consume
+struct ActionEvent
+{
+    Action action;
+    float x = 0.f;
+    float y = 0.f;
+};
+
+class InputMap
+{
+public:
+    InputMap()
+    {
+        keys[SDL_SCANCODE_ESCAPE] = Action::Quit;
+        keys[SDL_SCANCODE_SPACE] = Action::TogglePause;
+        buttons[SDL_BUTTON_LEFT] = Action::Scatter;
+    }
+
+    void BindKey(const SDL_Scancode scancode, const Action action) { keys[scancode] = action; }
+    void BindButton(const uint8_t button, const Action action) { buttons[button] = action; }
+
+    const Action* Key(const SDL_Scancode scancode) const
+    {
+        const auto found = keys.find(scancode);
+        return found != keys.end() ? &found->second : nullptr;
+    }
+
+    const Action* Button(const uint8_t button) const
+    {
+        const auto found = buttons.find(button);
+        return found != buttons.end() ? &found->second : nullptr;
+    }
+
+private:
+    std::unordered_map<SDL_Scancode, Action> keys;
+    std::unordered_map<uint8_t, Action> buttons;
+};
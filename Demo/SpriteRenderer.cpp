@@ -0,0 +1,62 @@
+#include "SpriteRenderer.hpp"
+#include <SDL3/SDL.h>
+#include <cmath>
+
+void SpriteRenderer::Draw(const RenderSnapshot& snapshot)
+{
+    drawCalls = 0;
+    SDL_Texture* batchTexture = nullptr;
+    for(const SpriteInstance& sprite : snapshot.sprites)
+    {
+        if(sprite.texture != batchTexture)
+        {
+            Flush(batchTexture);
+            batchTexture = sprite.texture;
+        }
+        AppendQuad(sprite);
+    }
+    Flush(batchTexture);
+}
+
+void SpriteRenderer::AppendQuad(const SpriteInstance& sprite)
+{
+    const float cos = std::cos(sprite.rotation);
+    const float sin = std::sin(sprite.rotation);
+
+    const float corners[4][2] = {{-1.f, -1.f}, {1.f, -1.f}, {1.f, 1.f}, {-1.f, 1.f}};
+    const float u0 = sprite.uv.x, v0 = sprite.uv.y;
+    const float u1 = sprite.uv.x + sprite.uv.w, v1 = sprite.uv.y + sprite.uv.h;
+    const float uvs[4][2] = {{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+
+    const int first = static_cast<int>(vertices.size());
+    for(int corner = 0; corner < 4; corner++)
+    {
+        const float localX = corners[corner][0] * sprite.halfWidth;
+        const float localY = corners[corner][1] * sprite.halfHeight;
+
+        SDL_Vertex vertex;
+        vertex.position.x = sprite.x + localX * cos - localY * sin;
+        vertex.position.y = sprite.y + localX * sin + localY * cos;
+        vertex.color = sprite.color;
+        vertex.tex_coord.x = uvs[corner][0];
+        vertex.tex_coord.y = uvs[corner][1];
+        vertices.push_back(vertex);
+    }
+
+    for(const int index : {0, 1, 2, 0, 2, 3})
+        indices.push_back(first + index);
+}
+
+void SpriteRenderer::Flush(SDL_Texture* texture)
+{
+    if(vertices.empty())
+        return;
+
+    if(!SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size())))
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't render sprite batch: %s", SDL_GetError());
+
+    drawCalls++;
+    vertices.clear();
+    indices.clear();
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "SDL3/SDL_render.h"
+#include "Components.hpp"
+
+// Turns a RenderSnapshot into quads, one SDL_RenderGeometry call per run of equal
+// textures. Touches no ECS state, so it can run while the world is updated.
+class SpriteRenderer
+{
+public:
+    explicit SpriteRenderer(SDL_Renderer* renderer) : renderer(renderer) {}
+
+    void Draw(const RenderSnapshot& snapshot);
+    uint32_t DrawCalls() const { return drawCalls; }
+
+private:
+    void AppendQuad(const SpriteInstance& sprite);
+    void Flush(SDL_Texture* texture);
+
+    SDL_Renderer* renderer;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    uint32_t drawCalls = 0;
+};
@@ -0,0 +1,163 @@
+#include "Systems.hpp"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+void MovementSystem::SetSignature(Signature& systemSignature)
+{
+    systemSignature.set(compManager->CompId<Transform>());
+    systemSignature.set(compManager->CompId<Velocity>());
+}
+
+void MovementSystem::SetResourceAccess(ResourceAccess& resourceAccess)
+{
+    resourceAccess.Read<Viewport>();
+    resourceAccess.Read<Events<ActionEvent>>();
+}
+
+void MovementSystem::Update(const float deltaTime)
+{
+    ReadEvents(actions).ForEach([&](const ActionEvent& action)
+    {
+        if(action.action == Action::TogglePause)
+            paused = !paused;
+    });
+    if(paused)
+        return;
+
+    const Viewport& viewport = ReadResource<Viewport>();
+    auto& transforms = compManager->GetComponentPool<Transform>();
+    auto& velocities = compManager->GetComponentPool<Velocity>();
+
+    for(EntityId entity : entities)
+    {
+        Transform& transform = transforms.GetComponent(entity);
+        Velocity& velocity = velocities.GetComponent(entity);
+
+        transform.x += velocity.x * deltaTime;
+        transform.y += velocity.y * deltaTime;
+        transform.rotation += velocity.angular * deltaTime;
+
+        if((transform.x < 0.f && velocity.x < 0.f) || (transform.x > viewport.width && velocity.x > 0.f))
+            velocity.x = -velocity.x;
+        if((transform.y < 0.f && velocity.y < 0.f) || (transform.y > viewport.height && velocity.y > 0.f))
+            velocity.y = -velocity.y;
+    }
+}
+
+void ScatterSystem::SetSignature(Signature& systemSignature)
+{
+    systemSignature.set(compManager->CompId<Transform>());
+    systemSignature.set(compManager->CompId<Velocity>());
+}
+
+void ScatterSystem::SetResourceAccess(ResourceAccess& resourceAccess)
+{
+    resourceAccess.Read<Events<ActionEvent>>();
+}
+
+void ScatterSystem::Update(const float deltaTime)
+{
+    points.clear();
+    ReadEvents(actions).ForEach([&](const ActionEvent& action)
+    {
+        if(action.action == Action::Scatter)
+            points.push_back({action.x, action.y});
+    });
+    if(points.empty())
+        return;
+
+    constexpr float strength = 200000.f;
+    auto& transforms = compManager->GetComponentPool<Transform>();
+    auto& velocities = compManager->GetComponentPool<Velocity>();
+    for(EntityId entity : entities)
+    {
+        const Transform& transform = std::as_const(transforms).GetComponent(entity);
+        Velocity& velocity = velocities.GetComponent(entity);
+        for(const SDL_FPoint& point : points)
+        {
+            const float dx = transform.x - point.x;
+            const float dy = transform.y - point.y;
+            const float distanceSquared = std::max(dx * dx + dy * dy, 100.f);
+            velocity.x += dx * strength / (distanceSquared * std::sqrt(distanceSquared));
+            velocity.y += dy * strength / (distanceSquared * std::sqrt(distanceSquared));
+        }
+    }
+}
+
+void TextureBindSystem::SetSignature(Signature& systemSignature)
+{
+    systemSignature.set(compManager->CompId<TextureHandle>());
+    systemSignature.set(compManager->CompId<Sprite>());
+}
+
+void TextureBindSystem::Update(const float deltaTime)
+{
+    const auto& handles = std::as_const(compManager->GetComponentPool<TextureHandle>());
+
+    // Walk the dense Sprite pool so bound sprites cost one pointer check
+    compManager->GetComponentPool<Sprite>().ForEach([&](const EntityId entity, Sprite& sprite)
+    {
+        if(sprite.texture || !entities.Contains(entity))
+            return;
+
+        const TextureHandle& handle = handles.GetComponent(entity);
+        if(!assets->IsReady(handle))
+            return;
+
+        const TextureRegion& region = assets->Get(handle.asset);
+        sprite.texture = region.texture;
+        sprite.uv = {region.uv.x + handle.uv.x * region.uv.w, region.uv.y + handle.uv.y * region.uv.h,
+                     handle.uv.w * region.uv.w, handle.uv.h * region.uv.h};
+    });
+}
+
+void SpriteExtractSystem::SetSignature(Signature& systemSignature)
+{
+    systemSignature.set(compManager->CompId<Transform>());
+    systemSignature.set(compManager->CompId<Sprite>());
+}
+
+void SpriteExtractSystem::SetResourceAccess(ResourceAccess& resourceAccess)
+{
+    resourceAccess.Write<RenderSnapshot>();
+}
+
+void SpriteExtractSystem::Render()
+{
+    auto& sprites = compManager->GetComponentPool<Sprite>();
+    const auto& transforms = std::as_const(compManager->GetComponentPool<Transform>());
+
+    auto drawOrder = [](const Sprite& a, const Sprite& b)
+    {
+        if(a.layer != b.layer)
+            return a.layer < b.layer;
+        return a.texture < b.texture;
+    };
+
+    // Insertion sort only pays off when few sprites changed layer or texture since last frame
+    uint32_t outOfOrder = 0;
+    const Sprite* previous = nullptr;
+    sprites.ForEach([&](const EntityId, const Sprite& sprite)
+    {
+        if(previous && drawOrder(sprite, *previous))
+            outOfOrder++;
+        previous = &sprite;
+    });
+    if(outOfOrder > 0)
+        sprites.Sort(drawOrder, outOfOrder < 64 ? SortAlgorithm::Insertion : SortAlgorithm::Standard);
+
+    auto& snapshot = WriteResource<RenderSnapshot>().sprites;
+    snapshot.clear();
+    sprites.ForEach([&](const EntityId entity, const Sprite& sprite)
+    {
+        if(!sprite.texture || !entities.Contains(entity))
+            return;
+
+        const Transform& transform = transforms.GetComponent(entity);
+        snapshot.push_back({sprite.texture, sprite.uv, sprite.color,
+                            transform.x, transform.y, transform.rotation,
+                            sprite.width * transform.scale * 0.5f, sprite.height * transform.scale * 0.5f});
+    });
+}
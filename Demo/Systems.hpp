@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include "AssetManager.hpp"
+#include "Components.hpp"
+#include "Input.hpp"
+#include "System.hpp"
+
+// Moves sprites by their velocity and bounces them off the viewport edges,
+// TogglePause actions stop and resume it
+class MovementSystem : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override;
+    void SetResourceAccess(ResourceAccess& resourceAccess) override;
+    void Update(const float deltaTime) override;
+
+private:
+    EventReader<ActionEvent> actions;
+    bool paused = false;
+};
+
+// Pushes sprites away from every Scatter point of the frame, all points are
+// applied in one pass over the entities
+class ScatterSystem : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override;
+    void SetResourceAccess(ResourceAccess& resourceAccess) override;
+    void Update(const float deltaTime) override;
+
+private:
+    EventReader<ActionEvent> actions;
+    std::vector<SDL_FPoint> points;
+};
+
+// Points sprites at their atlas region once the TextureHandle finished loading,
+// until then the sprite has no texture and is not drawn
+class TextureBindSystem : public System
+{
+public:
+    explicit TextureBindSystem(const AssetManager* assets) : assets(assets) {}
+
+    void SetSignature(Signature& systemSignature) override;
+    void Update(const float deltaTime) override;
+
+private:
+    const AssetManager* assets;
+};
+
+// Copies every Transform + Sprite entity into the RenderSnapshot resource. The
+// Sprite pool is kept sorted by layer and texture, after the first frame that is
+// a linear check unless sprites were added or changed.
+class SpriteExtractSystem : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override;
+    void SetResourceAccess(ResourceAccess& resourceAccess) override;
+    void Render() override;
+};
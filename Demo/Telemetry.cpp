@@ -0,0 +1,79 @@
+#include "Telemetry.hpp"
+#include <cstdio>
+#include "Clock.hpp"
+
+void FrameTelemetry::Enable(const std::string& path, const size_t expectedFrames)
+{
+    enabled = true;
+    this->path = path;
+    frames.reserve(expectedFrames);
+}
+
+void FrameTelemetry::BeginFrame()
+{
+    if(!enabled)
+        return;
+
+    current = FrameTimings{};
+    frameStartCycles = ReadCycleCounter();
+    frameStartNs = ReadNanoseconds();
+    phaseStartNs = frameStartNs;
+}
+
+void FrameTelemetry::EndPhase(const FramePhase phase)
+{
+    if(!enabled)
+        return;
+
+    const uint64_t now = ReadNanoseconds();
+    current.phaseMs[static_cast<size_t>(phase)] += (now - phaseStartNs) * 1e-6;
+    phaseStartNs = now;
+}
+
+void FrameTelemetry::EndFrame()
+{
+    if(!enabled)
+        return;
+
+    current.megaCycles = (ReadCycleCounter() - frameStartCycles) * 1e-6;
+    current.totalMs = (ReadNanoseconds() - frameStartNs) * 1e-6;
+    frames.push_back(current);
+}
+
+bool FrameTelemetry::Save() const
+{
+    if(!enabled)
+        return false;
+
+    FILE* file = std::fopen(path.c_str(), "w");
+    if(!file)
+        return false;
+
+    std::fprintf(file, "frame");
+    for(size_t phase = 0; phase < static_cast<size_t>(FramePhase::Count); phase++)
+        std::fprintf(file, "\t%s_ms", PhaseName(static_cast<FramePhase>(phase)));
+    std::fprintf(file, "\ttotal_ms\tmega_cycles\n");
+
+    for(size_t frame = 0; frame < frames.size(); frame++)
+    {
+        std::fprintf(file, "%zu", frame);
+        for(const double ms : frames[frame].phaseMs)
+            std::fprintf(file, "\t%.4f", ms);
+        std::fprintf(file, "\t%.4f\t%.4f\n", frames[frame].totalMs, frames[frame].megaCycles);
+    }
+
+    return std::fclose(file) == 0;
+}
+
+const char* FrameTelemetry::PhaseName(const FramePhase phase)
+{
+    switch(phase)
+    {
+        case FramePhase::Input: return "input";
+        case FramePhase::Update: return "update";
+        case FramePhase::Extract: return "extract";
+        case FramePhase::Render: return "render";
+        case FramePhase::Present: return "present";
+        default: return "unknown";
+    }
+}
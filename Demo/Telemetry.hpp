@@ -0,0 +1,50 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class FramePhase
+{
+    Input,
+    Update,
+    Extract,
+    Render,
+    Present,
+    Count
+};
+
+struct FrameTimings
+{
+    std::array<double, static_cast<size_t>(FramePhase::Count)> phaseMs{};
+    double totalMs = 0.0;
+    double megaCycles = 0.0;
+};
+
+// Per-frame phase timings, enabled at runtime with --telemetry. Samples stay in
+// memory and are written as TSV once the run ends so the file I/O does not land
+// inside measured frames. Compare runs with CompareTelemetry.py.
+class FrameTelemetry
+{
+public:
+    void Enable(const std::string& path, const size_t expectedFrames = 1 << 16);
+    bool IsEnabled() const { return enabled; }
+
+    void BeginFrame();
+    void EndPhase(const FramePhase phase);
+    void EndFrame();
+
+    const std::vector<FrameTimings>& Frames() const { return frames; }
+    bool Save() const;
+
+    static const char* PhaseName(const FramePhase phase);
+
+private:
+    bool enabled = false;
+    std::string path;
+    std::vector<FrameTimings> frames;
+    FrameTimings current;
+    uint64_t frameStartNs = 0;
+    uint64_t phaseStartNs = 0;
+    uint64_t frameStartCycles = 0;
+};
@@ -1,28 +1,96 @@
 #include "App.hpp"
 #include <SDL3/SDL.h>
-#include "Benchmark.hpp"
-#include <fstream>
-#include <string>
+#include <cstdlib>
+#include <cstring>
+#include "Telemetry.hpp"
 
 int main(int argc, char* argv[])
 {
-    App app;
-    //std::ofstream benchmarkFile("benchmark.txt");
-    //int it = 0;
-	bool isQuiting = false;
-    while (!isQuiting) {
-		//Benchmark benchmark;
-        //benchmark.Start();
+    AppConfig config;
+    const char* telemetryPath = nullptr;
+    for(int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if(std::strcmp(argv[i], "--telemetry") == 0 && hasValue)
+            telemetryPath = argv[++i];
+        else if(std::strcmp(argv[i], "--sprites") == 0 && hasValue)
+            config.sprites = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--seed") == 0 && hasValue)
+            config.seed = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--frames") == 0 && hasValue)
+            config.frames = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--fixed-dt") == 0 && hasValue)
+            config.fixedDeltaTime = std::strtof(argv[++i], nullptr);
+        else if(std::strcmp(argv[i], "--headless") == 0)
+            config.headless = true;
+        else if(std::strcmp(argv[i], "--pipelined") == 0)
+            config.pipelined = true;
+        else
+        {
+            SDL_Log("usage: %s [--headless] [--pipelined] [--frames N] [--sprites N] [--seed N] [--fixed-dt SECONDS] [--telemetry FILE]", argv[0]);
+            return 1;
+        }
+    }
+
+    if(config.sprites > MAX_ENTITY_COUNT)
+    {
+        SDL_Log("--sprites is limited to %u, configure with -DECS_MAX_ENTITY_COUNT to raise it", MAX_ENTITY_COUNT);
+        return 1;
+    }
+
+    // Headless runs are benchmarks: bounded and with the same simulation every time
+    if(config.headless)
+    {
+        if(config.frames == 0)
+            config.frames = 1000;
+        if(config.fixedDeltaTime == 0.f)
+            config.fixedDeltaTime = 1.f / 60.f;
+    }
+
+    FrameTelemetry telemetry;
+    if(telemetryPath)
+        telemetry.Enable(telemetryPath, config.frames > 0 ? config.frames : 1 << 16);
+
+    App app(config);
+    bool isQuiting = false;
+    for (uint32_t frame = 0; !isQuiting && (config.frames == 0 || frame < config.frames); frame++) {
+        telemetry.BeginFrame();
         isQuiting = app.ProcessInputs();
+        telemetry.EndPhase(FramePhase::Input);
+
+        if (config.pipelined)
+        {
+            // Update and Extract of the next frame run on the worker during Render and
+            // Present, the Update phase is only the time spent waiting for it
+            app.BeginUpdate();
+            app.Render();
+            telemetry.EndPhase(FramePhase::Render);
+
+            app.Present();
+            telemetry.EndPhase(FramePhase::Present);
+
+            app.EndUpdate();
+            telemetry.EndPhase(FramePhase::Update);
+        }
+        else
+        {
+            app.Update();
+            telemetry.EndPhase(FramePhase::Update);
+
+            app.Extract();
+            telemetry.EndPhase(FramePhase::Extract);
+
+            app.Render();
+            telemetry.EndPhase(FramePhase::Render);
 
-        app.Update();
-        app.Render();
+            app.Present();
+            telemetry.EndPhase(FramePhase::Present);
+        }
+        telemetry.EndFrame();
+    }
 
-        //auto benchmarkData =benchmark.Measure();
-        //benchmarkFile << it << '\t' << benchmarkData.miliSec << '\t' << benchmarkData.megaCycles << '\n'; 
-        //it++;
-	}
-    //benchmarkFile.close();
+    if(telemetry.IsEnabled() && !telemetry.Save())
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write telemetry");
 
-	return 0;
+    return 0;
 }
@@ -1,18 +1,37 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <numeric>
 #include <optional>
-#include <stack>
-#include <unordered_map>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include <typeinfo>
+#include "PagedArray.hpp"
+#include "Stats.hpp"
 #include "Types.hpp"
 
+enum class SortAlgorithm
+{
+    Standard,
+    Insertion // linear for nearly sorted pools
+};
+
 class IComponentPool
 {
 public:
     virtual bool TryDeleteComponent(const EntityId) = 0;
+    virtual std::unique_ptr<IComponentPool> Clone() const = 0;
+    virtual PoolStats GetStats() const = 0;
     virtual ~IComponentPool() {};
 };
 
+// Components are kept densely packed, deleting a component moves the last one
+// into its slot, so references are only valid until the next deletion.
 template <typename Component>
 class ComponentPool : public IComponentPool
 {
@@ -23,47 +42,42 @@ private:
 public:
 
     ComponentPool(ComponentId MAX_SIZE = MAX_ENTITY_COUNT)
-    {
-        components.resize(MAX_SIZE);
-        for(ComponentId id = MAX_SIZE; id > 0; id--)
-            availableIds.push(id - 1);
-    }
+        : components(MAX_SIZE), entities(MAX_SIZE) {}
 
     Component& AddComponent(const EntityId entity)
     {
-        ASSERT(availableIds.size() > 0 && entityToComponentId.find(entity) == entityToComponentId.end());
+        ASSERT(size < components.Size() && entity < MAX_ENTITY_COUNT && !Contains(entity));
 
-        entityToComponentId[entity] = availableIds.top();
-        availableIds.pop();
-        return components[entityToComponentId[entity]];
+        const ComponentId compId = size++;
+        entityToComponentId.Mutable(entity) = compId;
+        entities.Mutable(compId) = entity;
+        return components.Mutable(compId);
     }
-    
+
     Component& GetComponent(const EntityId entity)
     {
-        ComponentId compId = entityToComponentId[entity];
-        ASSERT(entityToComponentId.find(entity) != entityToComponentId.end());
-        return components[compId];   
+        ASSERT(Contains(entity));
+        return components.Mutable(entityToComponentId[entity]);
     }
-    
+
     const Component& GetComponent(const EntityId entity) const
-    { 
-        ComponentId compId = entityToComponentId.at(entity);
-        ASSERT(entityToComponentId.find(entity) != entityToComponentId.end());
-        return components[compId];   
+    {
+        ASSERT(Contains(entity));
+        return components[entityToComponentId[entity]];
     }
-    
+
     std::optional<std::reference_wrapper<Component>> TryGetComponent(const EntityId entity)
     {
-        if(entityToComponentId.find(entity) != entityToComponentId.end())
-            return {components[entity]};
+        if(Contains(entity))
+            return {components.Mutable(entityToComponentId[entity])};
         else
             return {};
     }
-    
+
     std::optional<std::reference_wrapper<const Component>> TryGetComponent(const EntityId entity) const
-    { 
-        if(entityToComponentId.find(entity) != entityToComponentId.end())
-            return {components[entity]};
+    {
+        if(Contains(entity))
+            return {components[entityToComponentId[entity]]};
         else
             return {};
     }
@@ -71,29 +85,290 @@ public:
 
     bool TryDeleteComponent(const EntityId entity) override
     {
-        if(entityToComponentId.find(entity) == entityToComponentId.end())
+        if(!Contains(entity))
             return false;
 
-        availableIds.push(entity);
-        entityToComponentId.erase(entity);
-
+        Remove(entity);
         return true;
     }
 
     void DeleteComponent(const EntityId entity)
     {
-        ASSERT(entityToComponentId.find(entity) != entityToComponentId.end());
-        availableIds.push(entity);
-        entityToComponentId.erase(entity);
+        ASSERT(Contains(entity));
+        Remove(entity);
+    }
+
+    bool Contains(const EntityId entity) const
+    {
+        return entity < MAX_ENTITY_COUNT && entityToComponentId[entity] != INVALID_ID;
     }
-    
+
+    // Disabled components keep their slot and data, only ForEach skips them
+    void Disable(const EntityId entity)
+    {
+        ASSERT(Contains(entity));
+        const ComponentId compId = entityToComponentId[entity];
+        if(SlotDisabled(compId))
+            return;
+
+        if(disabled.empty())
+            disabled.resize((components.Size() + 63) / 64);
+        FlipSlot(compId);
+        disabledCount++;
+    }
+
+    void Enable(const EntityId entity)
+    {
+        ASSERT(Contains(entity));
+        const ComponentId compId = entityToComponentId[entity];
+        if(!SlotDisabled(compId))
+            return;
+
+        FlipSlot(compId);
+        disabledCount--;
+    }
+
+    bool IsEnabled(const EntityId entity) const
+    {
+        ASSERT(Contains(entity));
+        return !SlotDisabled(entityToComponentId[entity]);
+    }
+
+    ComponentId Size() const { return size; }
+    ComponentId DisabledCount() const { return disabledCount; }
+    ComponentId Capacity() const { return components.Size(); }
+    EntityId EntityAt(const ComponentId index) const { return entities[index]; }
+    PagedArray<EntityId>::ConstRange Entities() const { return entities.Range(0, size); }
+
+    // Dense storage in contiguous runs, func(firstSlot, entities, components)
+    template <typename Func>
+    void ForEachChunk(Func func) const
+    {
+        for(ComponentId first = 0; first < size;)
+        {
+            const auto entityChunk = entities.Chunk(first, size - first);
+            const auto componentChunk = components.Chunk(first, entityChunk.size());
+            const size_t count = std::min(entityChunk.size(), componentChunk.size());
+            func(first, entityChunk.first(count), componentChunk.first(count));
+            first += count;
+        }
+    }
+
+    // Appends the same value for every entity, trivially copyable components are
+    // written with memcpy a page at a time
+    void FillComponents(std::span<const EntityId> newEntities, const Component& value)
+    {
+        const ComponentId count = newEntities.size();
+        ASSERT(size + count <= components.Size());
+        for(const EntityId entity : newEntities)
+            ASSERT(entity < MAX_ENTITY_COUNT && !Contains(entity));
+
+        for(ComponentId written = 0; written < count;)
+        {
+            auto chunk = components.MutableChunk(size + written, count - written);
+            if constexpr (std::is_trivially_copyable_v<Component>)
+            {
+                std::memcpy(&chunk[0], &value, sizeof(Component));
+                for(size_t filled = 1; filled < chunk.size(); filled *= 2)
+                    std::memcpy(&chunk[filled], &chunk[0], std::min(filled, chunk.size() - filled) * sizeof(Component));
+            }
+            else
+                std::fill(chunk.begin(), chunk.end(), value);
+            written += chunk.size();
+        }
+
+        for(ComponentId written = 0; written < count;)
+        {
+            auto chunk = entities.MutableChunk(size + written, count - written);
+            std::memcpy(chunk.data(), newEntities.data() + written, chunk.size() * sizeof(EntityId));
+            written += chunk.size();
+        }
+
+        for(const EntityId entity : newEntities)
+            entityToComponentId.Mutable(entity) = size++;
+    }
+
+    // Visits enabled components, disabled ones are skipped 64 slots at a time
+    template <typename Func>
+    void ForEach(Func func)
+    {
+        if(disabledCount == 0)
+        {
+            for(ComponentId id = 0; id < size; id++)
+                func(entities[id], components.Mutable(id));
+            return;
+        }
+
+        for(ComponentId base = 0; base < size; base += 64)
+        {
+            uint64_t enabled = ~disabled[base / 64];
+            if(size - base < 64)
+                enabled &= (uint64_t(1) << (size - base)) - 1;
+            while(enabled)
+            {
+                const ComponentId id = base + std::countr_zero(enabled);
+                enabled &= enabled - 1;
+                func(entities[id], components.Mutable(id));
+            }
+        }
+    }
+
+    // Reorders dense storage, compare takes two components like std::sort
+    template <typename Compare>
+    void Sort(Compare compare, const SortAlgorithm algorithm = SortAlgorithm::Standard)
+    {
+        std::vector<ComponentId> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        auto compareIds = [&](const ComponentId a, const ComponentId b)
+        {
+            return compare(components[a], components[b]);
+        };
+
+        if(algorithm == SortAlgorithm::Insertion)
+        {
+            for(ComponentId i = 1; i < size; i++)
+                for(ComponentId j = i; j > 0 && compareIds(order[j], order[j - 1]); j--)
+                    std::swap(order[j], order[j - 1]);
+        }
+        else
+            std::sort(order.begin(), order.end(), compareIds);
+
+        Permute(order);
+    }
+
+    // Moves entities present in order to the front, keeping the order they appear in
+    template <typename Entities>
+    void SortAs(const Entities& order)
+    {
+        ComponentId position = 0;
+        for(const EntityId entity : order)
+        {
+            if(!Contains(entity))
+                continue;
+
+            const ComponentId compId = entityToComponentId[entity];
+            if(compId != position)
+                Swap(compId, position);
+            position++;
+        }
+    }
+
+    std::unique_ptr<IComponentPool> Clone() const override
+    {
+        return std::make_unique<ComponentPool<Component>>(*this);
+    }
+
+    PoolStats GetStats() const override
+    {
+        PoolStats stats;
+        stats.name = Demangle(typeid(Component).name());
+        stats.live = size;
+        stats.capacity = Capacity();
+        stats.componentSize = sizeof(Component);
+        stats.bytesReserved = components.ReservedBytes() + entities.ReservedBytes() + entityToComponentId.ReservedBytes();
+        stats.bytesUsed = size * (sizeof(Component) + sizeof(EntityId) + sizeof(ComponentId));
+        stats.sharedPages = components.SharedPages() + entities.SharedPages() + entityToComponentId.SharedPages();
+        return stats;
+    }
+
     const Component& operator[] (const EntityId entity) const;
     Component& operator[] (const EntityId entity);
 
 private:
-    std::vector<Component> components;
-    std::unordered_map<EntityId, ComponentId> entityToComponentId;
-    std::stack<ComponentId> availableIds; 
-    //TODO: check is it really a good idea    
-};
+    void Remove(const EntityId entity)
+    {
+        const ComponentId compId = entityToComponentId[entity];
+        const ComponentId last = --size;
+        if(disabledCount > 0)
+        {
+            if(SlotDisabled(compId))
+            {
+                FlipSlot(compId);
+                disabledCount--;
+            }
+            if(compId != last && SlotDisabled(last))
+            {
+                FlipSlot(last);
+                FlipSlot(compId);
+            }
+        }
+        if(compId != last)
+        {
+            const EntityId movedEntity = entities[last];
+            components.Mutable(compId) = std::move(components.Mutable(last));
+            entities.Mutable(compId) = movedEntity;
+            entityToComponentId.Mutable(movedEntity) = compId;
+        }
+        entityToComponentId.Mutable(entity) = INVALID_ID;
+    }
+
+    void Swap(const ComponentId a, const ComponentId b)
+    {
+        if(SlotDisabled(a) != SlotDisabled(b))
+        {
+            FlipSlot(a);
+            FlipSlot(b);
+        }
+        std::swap(components.Mutable(a), components.Mutable(b));
+        const EntityId entityA = entities[a];
+        const EntityId entityB = entities[b];
+        entities.Mutable(a) = entityB;
+        entities.Mutable(b) = entityA;
+        entityToComponentId.Mutable(entityA) = b;
+        entityToComponentId.Mutable(entityB) = a;
+    }
+
+    // order[i] is the slot whose component ends up at i, cycles are rotated in place
+    void Permute(std::vector<ComponentId>& order)
+    {
+        if(disabledCount > 0)
+        {
+            std::vector<uint64_t> permuted(disabled.size());
+            for(ComponentId i = 0; i < size; i++)
+                if(SlotDisabled(order[i]))
+                    permuted[i / 64] |= uint64_t(1) << (i % 64);
+            disabled.swap(permuted);
+        }
+
+        for(ComponentId i = 0; i < size; i++)
+        {
+            if(order[i] == i)
+                continue;
 
+            Component component = std::move(components.Mutable(i));
+            const EntityId entity = entities[i];
+            ComponentId current = i;
+            while(order[current] != i)
+            {
+                const ComponentId next = order[current];
+                components.Mutable(current) = std::move(components.Mutable(next));
+                entities.Mutable(current) = entities[next];
+                entityToComponentId.Mutable(entities[current]) = current;
+                order[current] = current;
+                current = next;
+            }
+            components.Mutable(current) = std::move(component);
+            entities.Mutable(current) = entity;
+            entityToComponentId.Mutable(entity) = current;
+            order[current] = current;
+        }
+    }
+
+    bool SlotDisabled(const ComponentId compId) const
+    {
+        return disabledCount > 0 && (disabled[compId / 64] >> (compId % 64)) & 1;
+    }
+
+    void FlipSlot(const ComponentId compId)
+    {
+        disabled[compId / 64] ^= uint64_t(1) << (compId % 64);
+    }
+
+    PagedArray<Component> components;
+    PagedArray<EntityId> entities;
+    PagedArray<ComponentId> entityToComponentId{MAX_ENTITY_COUNT, INVALID_ID};
+    ComponentId size = 0;
+    // One bit per dense slot, allocated on the first Disable
+    std::vector<uint64_t> disabled;
+    ComponentId disabledCount = 0;
+};
@@ -5,7 +5,10 @@
 #include <optional>
 #include <span>
 #include <typeindex>
+#include <unordered_map>
+#include <vector>
 #include "Component.hpp"
+#include "SharedComponent.hpp"
 #include "Types.hpp"
 
 class ComponentManager
@@ -13,25 +16,40 @@ class ComponentManager
     using ComponentPoolId = uint16_t;
 
 public:
+    ComponentManager() = default;
+
+    ComponentManager(const ComponentManager& other)
+        : numberOfComponentPools(other.numberOfComponentPools), typeToCompId(other.typeToCompId)
+    {
+        for(ComponentPoolId i = 0; i < numberOfComponentPools; i++)
+            components[i] = other.components[i]->Clone();
+    }
+
+    ComponentManager& operator=(const ComponentManager&) = delete;
+
+    // Read only lookup, safe to call from worker threads once pools are registered
     template<typename Component>
-    constexpr ComponentPoolId CompId()
+    ComponentPoolId CompId() const
     {
-        ASSERT(typeToCompId.find(std::type_index(typeid(Component))) != typeToCompId.end());
-        return typeToCompId[std::type_index(typeid(Component))];
+        const auto it = typeToCompId.find(std::type_index(typeid(Component)));
+        ASSERT(it != typeToCompId.end());
+        return it->second;
     }
 
     template<typename Component>
     ComponentPool<Component>& GetComponentPool()
     {
-        return *dynamic_cast<ComponentPool<Component>*>
-            (components[CompId<Component>()].get());
+        auto* pool = dynamic_cast<ComponentPool<Component>*>(components[CompId<Component>()].get());
+        ASSERT(pool != nullptr);
+        return *pool;
     }
     
     template<typename Component>
     const ComponentPool<Component>& GetComponentPool() const
     {
-        return *dynamic_cast<ComponentPool<Component>*>
-            (components[CompId<Component>()].get());
+        auto* pool = dynamic_cast<ComponentPool<Component>*>(components[CompId<Component>()].get());
+        ASSERT(pool != nullptr);
+        return *pool;
     }
     
     template <typename Component>
@@ -43,6 +61,31 @@ public:
         numberOfComponentPools++;
     }
 
+    template <typename Component>
+    void RegisterSharedComponentPool(ComponentId MAX_SIZE = MAX_ENTITY_COUNT)
+    {
+        ASSERT(typeToCompId.find(std::type_index(typeid(Component))) == typeToCompId.end());
+        typeToCompId[std::type_index(typeid(Component))] = numberOfComponentPools;
+        components[numberOfComponentPools] = std::make_unique<SharedComponentPool<Component>>(MAX_SIZE);
+        numberOfComponentPools++;
+    }
+
+    template<typename Component>
+    SharedComponentPool<Component>& GetSharedComponentPool()
+    {
+        auto* pool = dynamic_cast<SharedComponentPool<Component>*>(components[CompId<Component>()].get());
+        ASSERT(pool != nullptr);
+        return *pool;
+    }
+
+    template<typename Component>
+    const SharedComponentPool<Component>& GetSharedComponentPool() const
+    {
+        auto* pool = dynamic_cast<SharedComponentPool<Component>*>(components[CompId<Component>()].get());
+        ASSERT(pool != nullptr);
+        return *pool;
+    }
+
     template <typename Component>
     Component& GetComponent(const EntityId entity)
     {
@@ -100,6 +143,14 @@ public:
             components[i]->TryDeleteComponent(entity);
     }
 
+    std::vector<PoolStats> GetPoolStats() const
+    {
+        std::vector<PoolStats> stats;
+        for(ComponentPoolId i = 0; i < numberOfComponentPools; i++)
+            stats.push_back(components[i]->GetStats());
+        return stats;
+    }
+
     template<typename Component, typename... ARGS>
     void AddComponents(std::span<EntityId> entities, ARGS&&... args)
     {
@@ -1,45 +1,197 @@
 #include "ECS.hpp"
+#include <algorithm>
 #include "Types.hpp"
 
 ECS::ECS()
 {
-    signatures = new Signature[MAX_ENTITY_COUNT];
-    for(EntityId id = MAX_ENTITY_COUNT; id > 0; id--)
-        availableEntityIds.push(id - 1);
+}
+
+ECS::ECS(const ECS& other)
+    : systemCloners(other.systemCloners),
+      typeToSysId(other.typeToSysId),
+      numberOfSystems(other.numberOfSystems),
+      compManager(other.compManager),
+      resManager(other.resManager),
+      eventUpdaters(other.eventUpdaters),
+      entityAllocator(other.entityAllocator),
+      signatures(other.signatures),
+      hierarchy(other.hierarchy),
+      fixedTimestep(other.fixedTimestep)
+#ifdef ECS_PROFILING
+      , profiler(other.profiler)
+#endif // ECS_PROFILING
+{
+    for(SystemId id = 0; id < numberOfSystems; id++)
+    {
+        ASSERT(systemCloners[id] != nullptr);
+        systems[id] = systemCloners[id](*other.systems[id]);
+        systems[id]->compManager = &compManager;
+        systems[id]->resManager = &resManager;
+        systems[id]->scheduler = &tasks;
+    }
+    SetStageCount(other.stages.size());
 }
 
 ECS::~ECS()
 {
-    delete [] signatures;
+}
+
+std::unique_ptr<ECS> ECS::Clone() const
+{
+    return std::unique_ptr<ECS>(new ECS(*this));
 }
 
 EntityId ECS::CreateEntity()
 {
-    auto newEntity = availableEntityIds.top();
-    availableEntityIds.pop();
-    return newEntity;
+    ECS_PROFILE_STRUCTURAL_CHANGE()
+    return entityAllocator.Create();
+}
+
+std::vector<EntityId> ECS::InstantiateUnchecked(const Prefab& prefab, const uint32_t count)
+{
+    ECS_PROFILE_STRUCTURAL_CHANGE()
+    std::vector<EntityId> entities(count);
+    for(auto& entity : entities)
+    {
+        entity = entityAllocator.Create();
+        signatures.Mutable(entity) = prefab.signature;
+    }
+
+    for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
+        if(systems[sysId]->Matches(prefab.signature))
+            for(const auto entity : entities)
+                systems[sysId]->entities.Insert(entity);
+
+    for(const auto& component : prefab.components)
+        component->Fill(compManager, entities);
+    return entities;
 }
 
 void ECS::DestroyEntity(const EntityId entity)
 {
-    signatures[entity] = 0u;
+    ECS_PROFILE_STRUCTURAL_CHANGE()
+    signatures.Mutable(entity) = 0u;
     for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
-        systems[sysId]->OnEntityDestroyed(entity);        
+        if(systems[sysId]->entities.Contains(entity))
+            systems[sysId]->OnEntityDestroyed(entity);        
 
     compManager.DestroyAllComponents(entity);
-    availableEntityIds.push(entity);
+    if(hierarchy.Contains(entity))
+        hierarchy.Remove(entity);
+    entityAllocator.Release(entity);
+}
+
+void ECS::SetStageCount(const uint32_t count)
+{
+    stages.resize(count);
+    for(auto& stage : stages)
+        if(!stage)
+            stage = std::make_unique<ComponentStage>(compManager, entityAllocator);
+}
+
+void ECS::FlushStages()
+{
+    std::vector<EntityId> changed;
+    for(auto& stage : stages)
+        for(auto& staged : stage->stagedComponents)
+            if(staged)
+                staged->Apply(compManager, signatures, changed);
+    if(changed.empty())
+        return;
+
+    ECS_PROFILE_STRUCTURAL_CHANGE()
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
+        for(const auto entity : changed)
+            systems[sysId]->OnEntitySignatureChanged(entity, signatures[entity]);
 }
     
 void ECS::UpdateSystems(const float deltaTime)
 {
+    ECS_PROFILE_FRAME()
     for(SystemId id = 0; id < numberOfSystems; id++)
+    {
+        ECS_PROFILE_SYSTEM(id, ProfilePhase::Update, systems[id]->entities.size())
         systems[id].get()->Update(deltaTime);
+    }
+    tasks.Resume();
+    FlushStages();
+    hierarchy.Sort();
+    UpdateEvents();
+}
+
+void ECS::UpdateEvents()
+{
+    for(const auto updater : eventUpdaters)
+        updater(resManager);
 }
 
 void ECS::RenderSystems()
 {
+    const float alpha = fixedTimestep.Alpha();
     for(SystemId id = 0; id < numberOfSystems; id++)
-        systems[id].get()->Render();
+    {
+        ECS_PROFILE_SYSTEM(id, ProfilePhase::Render, systems[id]->entities.size())
+        systems[id].get()->RenderInterpolated(alpha);
+    }
+
+}
+
+void ECS::Tick(const float frameTime)
+{
+    ECS_PROFILE_FRAME()
+    const uint32_t steps = fixedTimestep.Advance(frameTime);
+    for(uint32_t step = 0; step < steps; step++)
+        for(SystemId id = 0; id < numberOfSystems; id++)
+            if(systems[id]->GetUpdateRate() == UpdateRate::Fixed)
+            {
+                ECS_PROFILE_SYSTEM(id, ProfilePhase::FixedUpdate, systems[id]->entities.size())
+                systems[id]->Update(fixedTimestep.Step());
+            }
+
+    for(SystemId id = 0; id < numberOfSystems; id++)
+        if(systems[id]->GetUpdateRate() == UpdateRate::PerFrame)
+        {
+            ECS_PROFILE_SYSTEM(id, ProfilePhase::Update, systems[id]->entities.size())
+            systems[id]->Update(frameTime);
+        }
+    tasks.Resume();
+    FlushStages();
+    hierarchy.Sort();
+    UpdateEvents();
+}
+
+void ECS::SetFixedTimestep(const float step, const uint32_t maxSteps)
+{
+    fixedTimestep.Configure(step, maxSteps);
+}
+
+void ECS::SetParent(const EntityId child, const EntityId parent)
+{
+    ECS_PROFILE_STRUCTURAL_CHANGE()
+    hierarchy.SetParent(child, parent);
+}
 
+void ECS::RemoveParent(const EntityId child)
+{
+    ECS_PROFILE_STRUCTURAL_CHANGE()
+    hierarchy.RemoveParent(child);
 }
 
+EntityId ECS::GetParent(const EntityId entity) const
+{
+    return hierarchy.Contains(entity) ? hierarchy.GetParent(entity) : INVALID_ID;
+}
+
+ECSStats ECS::Stats() const
+{
+    ECSStats stats;
+    stats.aliveEntities = entityAllocator.Alive();
+    stats.entityBytes = signatures.ReservedBytes() + entityAllocator.ReservedBytes();
+    stats.hierarchyBytes = hierarchy.ReservedBytes();
+    stats.pools = compManager.GetPoolStats();
+    for(SystemId id = 0; id < numberOfSystems; id++)
+        stats.systems.push_back(systems[id]->GetStats());
+    return stats;
+}
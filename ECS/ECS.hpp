@@ -2,15 +2,28 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <ranges>
 #include <span>
-#include <stack>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
 #include <utility>
 
 #include "ComponentManager.hpp"
+#include "EntityAllocator.hpp"
+#include "Events.hpp"
+#include "FixedTimestep.hpp"
+#include "Hierarchy.hpp"
+#include "PagedArray.hpp"
+#include "Prefab.hpp"
+#include "Profiler.hpp"
+#include "ResourceManager.hpp"
+#include "Staging.hpp"
+#include "Stats.hpp"
+#include "Task.hpp"
 #include "Types.hpp"
 #include "System.hpp"
+#include "TimeSlicedSystem.hpp"
 
 class ECS
 {
@@ -22,7 +35,17 @@ public:
         
         typeToSysId[std::type_index(typeid(System))] = numberOfSystems;
         systems[numberOfSystems] = std::make_unique<System>(std::forward<ARGS>(args) ...);
-        systems[numberOfSystems]->Init(signatures, &compManager);
+        systems[numberOfSystems]->typeName = typeid(System).name();
+        systems[numberOfSystems]->scheduler = &tasks;
+        systems[numberOfSystems]->Init(signatures, &compManager, &resManager);
+        if constexpr (std::is_copy_constructible_v<System>)
+            systemCloners[numberOfSystems] = [](const ::System& system) -> std::unique_ptr<::System>
+            {
+                return std::make_unique<System>(static_cast<const System&>(system));
+            };
+#ifdef ECS_PROFILING
+        profiler.SetSystemName(numberOfSystems, typeid(System).name());
+#endif // ECS_PROFILING
         numberOfSystems++;
     }
 
@@ -32,6 +55,80 @@ public:
         compManager.RegisterComponentPool<Component>(MAX_SIZE);
     }
 
+    template <typename Component>
+    ComponentPool<Component>& GetComponentPool()
+    {
+        return compManager.GetComponentPool<Component>();
+    }
+
+    // Components stored once per distinct value, see SharedComponentPool
+    template <typename Component>
+    void RegisterSharedComponentPool(ComponentId MAX_SIZE = MAX_ENTITY_COUNT)
+    {
+        compManager.RegisterSharedComponentPool<Component>(MAX_SIZE);
+    }
+
+    template <typename Component>
+    SharedComponentPool<Component>& GetSharedComponentPool()
+    {
+        return compManager.GetSharedComponentPool<Component>();
+    }
+
+    template <typename Resource, typename... ARGS>
+    Resource& SetResource(ARGS&&... args)
+    {
+        return resManager.SetResource<Resource>(std::forward<ARGS>(args)...);
+    }
+
+    template <typename Resource>
+    Resource& GetResource()
+    {
+        return resManager.GetResource<Resource>();
+    }
+
+    template <typename Resource>
+    const Resource& GetResource() const
+    {
+        return resManager.GetResource<Resource>();
+    }
+
+    template <typename Resource>
+    bool HasResource() const
+    {
+        return resManager.HasResource<Resource>();
+    }
+
+    // Events live in the Events<Event> resource and are recycled at the end of
+    // UpdateSystems() and Tick(), systems read them through an EventReader
+    template <typename Event>
+    Events<Event>& RegisterEvent()
+    {
+        ASSERT(!resManager.HasResource<Events<Event>>());
+        eventUpdaters.push_back([](ResourceManager& resources)
+        {
+            resources.GetResource<Events<Event>>().Update();
+        });
+        return resManager.SetResource<Events<Event>>();
+    }
+
+    template <typename Event>
+    Events<Event>& GetEvents()
+    {
+        return resManager.GetResource<Events<Event>>();
+    }
+
+    template <typename Event>
+    void SendEvent(const Event& event)
+    {
+        resManager.GetResource<Events<Event>>().Send(event);
+    }
+
+    template <typename Resource>
+    void RemoveResource()
+    {
+        resManager.RemoveResource<Resource>();
+    }
+
     template <typename Component>
     Component& GetComponent(const EntityId entity)
     {
@@ -61,18 +158,56 @@ public:
     template <typename Component, typename... ARGS>
     Component& AddComponent(const EntityId entity, ARGS&&... args)
     {
+        ECS_PROFILE_STRUCTURAL_CHANGE()
         auto& comp = compManager.AddComponent<Component>(entity, args...);
-        signatures[entity].set(compManager.CompId<Component>());
+        signatures.Mutable(entity).set(compManager.CompId<Component>());
         for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
             systems[sysId]->OnEntitySignatureChanged(entity, signatures[entity]);
         return comp;
     }
     
+    template <typename Component>
+    const Component& AddSharedComponent(const EntityId entity, const Component& value)
+    {
+        ECS_PROFILE_STRUCTURAL_CHANGE()
+        const auto& comp = compManager.GetSharedComponentPool<Component>().AddComponent(entity, value);
+        signatures.Mutable(entity).set(compManager.CompId<Component>());
+        for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
+            systems[sysId]->OnEntitySignatureChanged(entity, signatures[entity]);
+        return comp;
+    }
+
+    // Signature stays the same, only the entity's group changes
+    template <typename Component>
+    const Component& SetSharedComponent(const EntityId entity, const Component& value)
+    {
+        return compManager.GetSharedComponentPool<Component>().SetComponent(entity, value);
+    }
+
+    template <typename Component>
+    const Component& GetSharedComponent(const EntityId entity) const
+    {
+        return compManager.GetSharedComponentPool<Component>().GetComponent(entity);
+    }
+
+    template <typename Component>
+    void DeleteSharedComponent(const EntityId entity)
+    {
+        ASSERT(signatures[entity].test(compManager.CompId<Component>()));
+        ECS_PROFILE_STRUCTURAL_CHANGE()
+        signatures.Mutable(entity).reset(compManager.CompId<Component>());
+        for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
+            systems[sysId]->OnEntitySignatureChanged(entity, signatures[entity]);
+
+        compManager.GetSharedComponentPool<Component>().DeleteComponent(entity);
+    }
+
     template <typename Component>
     void DeleteComponent(const EntityId entity)
     {
         ASSERT(signatures[entity].test(compManager.CompId<Component>()));
-        signatures[entity].reset(compManager.CompId<Component>());
+        ECS_PROFILE_STRUCTURAL_CHANGE()
+        signatures.Mutable(entity).reset(compManager.CompId<Component>());
         for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
             systems[sysId]->OnEntitySignatureChanged(entity, signatures[entity]);
         
@@ -83,19 +218,42 @@ public:
     void TryDeleteComponent(const EntityId entity)
     {
         ASSERT(signatures[entity].test(compManager.CompId<Component>()));
-        signatures[entity].reset(compManager.CompId<Component>());
+        ECS_PROFILE_STRUCTURAL_CHANGE()
+        signatures.Mutable(entity).reset(compManager.CompId<Component>());
         for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
             systems[sysId]->OnEntitySignatureChanged(entity, signatures[entity]);
         
         compManager.TryDeleteComponent<Component>(entity);       
     }
 
+    // Keeps the component and the entity's system membership, pool ForEach and
+    // System::ForEachEnabled skip it until it is enabled again, loops over a
+    // system's entities do not
+    template <typename Component>
+    void Disable(const EntityId entity)
+    {
+        compManager.GetComponentPool<Component>().Disable(entity);
+    }
+
+    template <typename Component>
+    void Enable(const EntityId entity)
+    {
+        compManager.GetComponentPool<Component>().Enable(entity);
+    }
+
+    template <typename Component>
+    bool IsEnabled(const EntityId entity) const
+    {
+        return compManager.GetComponentPool<Component>().IsEnabled(entity);
+    }
+
     template<typename Component, typename... ARGS>
     void AddComponents(std::span<EntityId> entities, ARGS&&... args)
     {
         for(const auto ent : entities)
         {    
-            signatures[ent].set(compManager.CompId<Component>());
+            ECS_PROFILE_STRUCTURAL_CHANGE()
+            signatures.Mutable(ent).set(compManager.CompId<Component>());
             for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
                 systems[sysId]->OnEntitySignatureChanged(ent, signatures[ent]);
         }
@@ -107,7 +265,8 @@ public:
     { 
         for(const auto ent : entities)
         {   
-            signatures[ent].reset(compManager.CompId<Component>());
+            ECS_PROFILE_STRUCTURAL_CHANGE()
+            signatures.Mutable(ent).reset(compManager.CompId<Component>());
             for(SystemId sysId = 0; sysId < numberOfSystems; sysId++)
                 systems[sysId]->OnEntitySignatureChanged(ent, signatures[ent]);
         }
@@ -115,6 +274,43 @@ public:
         compManager.DeleteComponents<Component>(entities);
     }
 
+    template <typename Component, typename Compare>
+    void Sort(Compare compare, const SortAlgorithm algorithm = SortAlgorithm::Standard)
+    {
+        compManager.GetComponentPool<Component>().Sort(compare, algorithm);
+    }
+
+    template <typename Component, typename Reference>
+    void SortAs()
+    {
+        compManager.GetComponentPool<Component>().SortAs(compManager.GetComponentPool<Reference>().Entities());
+    }
+
+    template <typename Component>
+    void SortByHierarchy()
+    {
+        compManager.GetComponentPool<Component>().SortAs(
+            hierarchy.Nodes() | std::views::transform(&HierarchyNode::entity));
+    }
+
+    template <typename... Components>
+    Prefab CreatePrefab(const Components&... components)
+    {
+        Prefab prefab;
+        (prefab.Set(compManager, components), ...);
+        return prefab;
+    }
+
+    // Creates count entities with the prefab's components, system membership is
+    // decided once for the whole batch and component values are copied in bulk
+    std::vector<EntityId> Instantiate(const Prefab& prefab, const uint32_t count)
+    {
+        ASSERT(entityAllocator.Available() >= count);
+        for(const auto& component : prefab.components)
+            ASSERT(component->Fits(compManager, count));
+        return InstantiateUnchecked(prefab, count);
+    }
+
     void DestroyEntities(std::span<EntityId> entities)
     {
         for(const auto ent : entities)
@@ -122,20 +318,74 @@ public:
     }
 
     ECS();
+    ECS& operator=(const ECS&) = delete;
     ~ECS();
 
+    // Forks the world, component storage is shared with the original until written to.
+    // Every registered system has to be copy constructible.
+    std::unique_ptr<ECS> Clone() const;
+
+    // Lock free, may be called from any thread
     EntityId CreateEntity();
     void DestroyEntity(const EntityId entity);
+
+    // One stage per worker thread, components added through a stage are merged by
+    // FlushStages(), which UpdateSystems() and Tick() call before recycling events
+    void SetStageCount(const uint32_t count);
+    ComponentStage& GetStage(const uint32_t index) { return *stages[index]; }
+    void FlushStages();
+
+    // Tasks are resumed after the systems in UpdateSystems() and Tick(), before
+    // stages are flushed. A cloned world starts without tasks.
+    void StartTask(Task task) { tasks.Start(std::move(task)); }
+    TaskScheduler& GetTasks() { return tasks; }
+
     void UpdateSystems(const float deltaTime);
     void RenderSystems();
+    void UpdateEvents();
+
+    // Runs fixed rate systems as many steps as frameTime allows, then per frame systems
+    void Tick(const float frameTime);
+    void SetFixedTimestep(const float step, const uint32_t maxSteps);
+    const FixedTimestep& GetFixedTimestep() const { return fixedTimestep; }
+
+    void SetParent(const EntityId child, const EntityId parent);
+    void RemoveParent(const EntityId child);
+    EntityId GetParent(const EntityId entity) const;
+    const Hierarchy& GetHierarchy() const { return hierarchy; }
+
+    ECSStats Stats() const;
 
 private:
+    using SystemCloner = std::unique_ptr<System>(*)(const System&);
+    using EventUpdater = void(*)(ResourceManager&);
+
+    ECS(const ECS& other);
+
+    // Checked inline in Instantiate, so ASSERT behaves as in the caller's build
+    std::vector<EntityId> InstantiateUnchecked(const Prefab& prefab, const uint32_t count);
+
     std::array<std::unique_ptr<System>, MAX_SYSTEM_COUNT> systems;
+    std::array<SystemCloner, MAX_SYSTEM_COUNT> systemCloners{};
     std::unordered_map<std::type_index, SystemId> typeToSysId;
     SystemId numberOfSystems = 0;
    
     ComponentManager compManager{};
+    ResourceManager resManager{};
+    std::vector<EventUpdater> eventUpdaters;
+
+    EntityAllocator entityAllocator;
+    std::vector<std::unique_ptr<ComponentStage>> stages;
+    TaskScheduler tasks;
+    PagedArray<Signature> signatures{MAX_ENTITY_COUNT};
+    Hierarchy hierarchy;
+    FixedTimestep fixedTimestep;
 
-    std::stack<EntityId> availableEntityIds;
-    Signature* signatures;
+#ifdef ECS_PROFILING
+public:
+    Profiler& GetProfiler() { return profiler; }
+
+private:
+    Profiler profiler;
+#endif // ECS_PROFILING
 };
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "Types.hpp"
+
+// Lock free entity ids. Fresh ids come from an atomic bump counter, destroyed ids
+// go onto a LIFO free list whose head carries a tag against ABA, so jobs can
+// create entities while the main thread destroys others.
+class EntityAllocator
+{
+public:
+    EntityAllocator() : links(new std::atomic<EntityId>[MAX_ENTITY_COUNT]) {}
+
+    EntityAllocator(const EntityAllocator& other)
+        : links(new std::atomic<EntityId>[MAX_ENTITY_COUNT]),
+          head(other.head.load()),
+          next(other.next.load()),
+          recycled(other.recycled.load())
+    {
+        for(EntityId id = 0; id < next; id++)
+            links[id].store(other.links[id].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    EntityAllocator& operator=(const EntityAllocator&) = delete;
+
+    EntityId Create()
+    {
+        uint64_t top = head.load(std::memory_order_acquire);
+        while(Index(top) != INVALID_ID)
+        {
+            const EntityId entity = Index(top);
+            const uint64_t below = Pack(links[entity].load(std::memory_order_relaxed), Tag(top) + 1);
+            if(head.compare_exchange_weak(top, below, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                recycled.fetch_sub(1, std::memory_order_relaxed);
+                return entity;
+            }
+        }
+
+        EntityId fresh = next.load(std::memory_order_relaxed);
+        do
+        {
+            ASSERT(fresh < MAX_ENTITY_COUNT);
+        }
+        while(!next.compare_exchange_weak(fresh, fresh + 1, std::memory_order_relaxed));
+        return fresh;
+    }
+
+    void Release(const EntityId entity)
+    {
+        ASSERT(entity < next.load(std::memory_order_relaxed));
+        recycled.fetch_add(1, std::memory_order_relaxed);
+        uint64_t top = head.load(std::memory_order_relaxed);
+        do
+            links[entity].store(Index(top), std::memory_order_relaxed);
+        while(!head.compare_exchange_weak(top, Pack(entity, Tag(top) + 1), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    uint32_t Alive() const { return next.load() - recycled.load(); }
+    uint32_t Available() const { return MAX_ENTITY_COUNT - Alive(); }
+    size_t ReservedBytes() const { return MAX_ENTITY_COUNT * sizeof(std::atomic<EntityId>); }
+
+private:
+    static uint64_t Pack(const EntityId entity, const uint32_t tag) { return (uint64_t(tag) << 32) | entity; }
+    static EntityId Index(const uint64_t packed) { return EntityId(packed); }
+    static uint32_t Tag(const uint64_t packed) { return uint32_t(packed >> 32); }
+
+    std::unique_ptr<std::atomic<EntityId>[]> links;
+    std::atomic<uint64_t> head{Pack(INVALID_ID, 0)};
+    std::atomic<EntityId> next{0};
+    std::atomic<uint32_t> recycled{0};
+};
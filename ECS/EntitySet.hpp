@@ -0,0 +1,69 @@
+#pragma once
+#include "PagedArray.hpp"
+#include "Types.hpp"
+
+// Sparse set of entities, dense part is iterated in insertion order.
+class EntitySet
+{
+public:
+    EntitySet() : dense(MAX_ENTITY_COUNT), sparse(MAX_ENTITY_COUNT, INVALID_ID) {}
+
+    bool Contains(const EntityId entity) const
+    {
+        return entity < MAX_ENTITY_COUNT && sparse[entity] != INVALID_ID;
+    }
+
+    bool Insert(const EntityId entity)
+    {
+        if(Contains(entity))
+            return false;
+
+        ASSERT(entity < MAX_ENTITY_COUNT);
+        sparse.Mutable(entity) = count;
+        dense.Mutable(count) = entity;
+        count++;
+        return true;
+    }
+
+    bool Erase(const EntityId entity)
+    {
+        if(!Contains(entity))
+            return false;
+
+        uint32_t index = sparse[entity];
+        if(index < mark)
+        {
+            // Swap with the last marked entity first so no unmarked one moves below the mark
+            const EntityId lastMarked = dense[--mark];
+            dense.Mutable(index) = lastMarked;
+            sparse.Mutable(lastMarked) = index;
+            dense.Mutable(mark) = entity;
+            index = mark;
+        }
+
+        const EntityId last = dense[--count];
+        dense.Mutable(index) = last;
+        sparse.Mutable(last) = index;
+        sparse.Mutable(entity) = INVALID_ID;
+        return true;
+    }
+
+    EntityId operator[](const uint32_t index) const { return dense[index]; }
+
+    // Entities before the mark stay before it across Insert and Erase, which
+    // lets a partial walk over the set resume from the mark later on
+    uint32_t Mark() const { return mark; }
+    void SetMark(const uint32_t index) { ASSERT(index <= count); mark = index; }
+
+    size_t ReservedBytes() const { return dense.ReservedBytes() + sparse.ReservedBytes(); }
+
+    uint32_t size() const { return count; }
+    PagedArray<EntityId>::ConstIterator begin() const { return dense.Iterator(0); }
+    PagedArray<EntityId>::ConstIterator end() const { return dense.Iterator(count); }
+
+private:
+    PagedArray<EntityId> dense;
+    PagedArray<uint32_t> sparse;
+    uint32_t count = 0;
+    uint32_t mark = 0;
+};
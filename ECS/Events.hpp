@@ -0,0 +1,117 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include "Types.hpp"
+
+using EventCount = uint64_t;
+
+template <typename Event>
+class EventReader;
+
+// Events of one type. Two buffers are reused frame after frame, Update() at the
+// frame boundary recycles the older one, so an event stays readable during the
+// frame it was sent in and the next one. Each reader keeps its own cursor and
+// sees every event once, whatever order it runs in relative to the sender.
+template <typename Event>
+class Events
+{
+public:
+    void Send(const Event& event)
+    {
+        buffers[current].push_back(event);
+        sent++;
+    }
+
+    template <typename... ARGS>
+    Event& Emplace(ARGS&&... args)
+    {
+        sent++;
+        return buffers[current].emplace_back(std::forward<ARGS>(args)...);
+    }
+
+    template <typename Range>
+    void SendBatch(const Range& events)
+    {
+        for(const auto& event : events)
+            Send(event);
+    }
+
+    void Update()
+    {
+        current ^= 1;
+        buffers[current].clear();
+        start[current] = sent;
+    }
+
+    EventCount Sent() const { return sent; }
+    size_t Size() const { return buffers[0].size() + buffers[1].size(); }
+
+private:
+    friend class EventReader<Event>;
+
+    std::array<std::vector<Event>, 2> buffers;
+    std::array<EventCount, 2> start{};
+    uint32_t current = 0;
+    EventCount sent = 0;
+};
+
+// Events a reader has not seen yet, oldest first
+template <typename Event>
+struct EventBatch
+{
+    std::span<const Event> older;
+    std::span<const Event> newer;
+
+    size_t size() const { return older.size() + newer.size(); }
+    bool empty() const { return older.empty() && newer.empty(); }
+
+    template <typename Func>
+    void ForEach(Func func) const
+    {
+        for(const Event& event : older)
+            func(event);
+        for(const Event& event : newer)
+            func(event);
+    }
+};
+
+template <typename Event>
+class EventReader
+{
+public:
+    EventBatch<Event> Read(const Events<Event>& events)
+    {
+        const uint32_t older = events.current ^ 1;
+        const EventCount oldest = std::min(events.start[older], events.start[events.current]);
+        if(attached && cursor < oldest)
+            lost += oldest - cursor;
+
+        EventBatch<Event> batch{Unread(events, older), Unread(events, events.current)};
+        cursor = events.sent;
+        attached = true;
+        return batch;
+    }
+
+    // Events dropped before this reader got to them, it has to read at least every other frame
+    EventCount Lost() const { return lost; }
+
+private:
+    std::span<const Event> Unread(const Events<Event>& events, const uint32_t buffer) const
+    {
+        const auto& stored = events.buffers[buffer];
+        const EventCount first = events.start[buffer];
+        const EventCount from = std::max(cursor, first);
+        if(from >= first + stored.size())
+            return {};
+        return std::span<const Event>(stored).subspan(from - first);
+    }
+
+    EventCount cursor = 0;
+    EventCount lost = 0;
+    bool attached = false;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include "Types.hpp"
+
+enum class UpdateRate
+{
+    PerFrame,
+    Fixed
+};
+
+struct FixedTimestepStats
+{
+    uint32_t lastFrameSteps = 0;
+    uint32_t maxFrameSteps = 0;
+    uint64_t totalSteps = 0;
+    uint64_t totalFrames = 0;
+    uint64_t clampedFrames = 0;
+    double droppedTime = 0.0;
+
+    double AverageStepsPerFrame() const
+    {
+        return totalFrames == 0 ? 0.0 : static_cast<double>(totalSteps) / totalFrames;
+    }
+};
+
+// Accumulates frame time and hands out whole fixed steps. When a frame would need
+// more than maxSteps the leftover time is dropped, so a slow frame can't snowball.
+class FixedTimestep
+{
+public:
+    FixedTimestep(const float step = 1.0f / 60.0f, const uint32_t maxSteps = 5)
+    {
+        Configure(step, maxSteps);
+    }
+
+    void Configure(const float step, const uint32_t maxSteps)
+    {
+        ASSERT(step > 0.0f && maxSteps > 0);
+        this->step = step;
+        this->maxSteps = maxSteps;
+        accumulator = std::min(accumulator, static_cast<double>(step));
+    }
+
+    uint32_t Advance(const float frameTime)
+    {
+        accumulator += std::max(frameTime, 0.0f);
+        uint32_t steps = static_cast<uint32_t>(accumulator / step);
+        if(steps > maxSteps)
+        {
+            const double dropped = (steps - maxSteps) * static_cast<double>(step);
+            accumulator -= dropped;
+            stats.droppedTime += dropped;
+            stats.clampedFrames++;
+            steps = maxSteps;
+        }
+        accumulator -= steps * static_cast<double>(step);
+
+        stats.lastFrameSteps = steps;
+        stats.maxFrameSteps = std::max(stats.maxFrameSteps, steps);
+        stats.totalSteps += steps;
+        stats.totalFrames++;
+        return steps;
+    }
+
+    float Alpha() const { return static_cast<float>(accumulator / step); }
+    float Step() const { return step; }
+    uint32_t MaxSteps() const { return maxSteps; }
+    const FixedTimestepStats& Stats() const { return stats; }
+
+private:
+    float step;
+    uint32_t maxSteps;
+    double accumulator = 0.0;
+    FixedTimestepStats stats;
+};
@@ -0,0 +1,189 @@
+#include "Hierarchy.hpp"
+#include <algorithm>
+
+void Hierarchy::Attach(const EntityId child, const EntityId parent)
+{
+    if(!Contains(parent))
+        Insert(parent);
+    if(!Contains(child))
+        Insert(child);
+    if(links[child].parent == parent)
+        return;
+
+    Unlink(child);
+    Link(child, parent);
+    MoveSubtree(child, GetDepth(parent) + 1);
+}
+
+void Hierarchy::RemoveParent(const EntityId child)
+{
+    ASSERT(Contains(child));
+    if(links[child].parent == INVALID_ID)
+        return;
+
+    Unlink(child);
+    MoveSubtree(child, 0);
+}
+
+void Hierarchy::Remove(const EntityId entity)
+{
+    ASSERT(Contains(entity));
+    while(links[entity].firstChild != INVALID_ID)
+        RemoveParent(links[entity].firstChild);
+
+    Unlink(entity);
+    const uint32_t index = slots[entity];
+    MarkDirty(nodes[index].depth);
+    if(index != nodes.size() - 1)
+    {
+        nodes[index] = nodes.back();
+        const EntityId moved = nodes[index].entity;
+        slots.Mutable(moved) = index;
+        for(EntityId child = links[moved].firstChild; child != INVALID_ID; child = links[child].nextSibling)
+            nodes[slots[child]].parentIndex = index;
+    }
+    nodes.pop_back();
+    links.Mutable(entity) = Links{};
+    slots.Mutable(entity) = INVALID_ID;
+}
+
+bool Hierarchy::Contains(const EntityId entity) const
+{
+    return entity < MAX_ENTITY_COUNT && slots[entity] != INVALID_ID;
+}
+
+EntityId Hierarchy::GetParent(const EntityId entity) const
+{
+    ASSERT(Contains(entity));
+    return links[entity].parent;
+}
+
+uint32_t Hierarchy::GetDepth(const EntityId entity) const
+{
+    ASSERT(Contains(entity));
+    return nodes[slots[entity]].depth;
+}
+
+uint32_t Hierarchy::IndexOf(const EntityId entity) const
+{
+    ASSERT(Contains(entity));
+    Sort();
+    return slots[entity];
+}
+
+void Hierarchy::ForEachChild(const EntityId entity, const std::function<void(EntityId)>& func) const
+{
+    ASSERT(Contains(entity));
+    for(EntityId child = links[entity].firstChild; child != INVALID_ID; child = links[child].nextSibling)
+        func(child);
+}
+
+void Hierarchy::Insert(const EntityId entity)
+{
+    slots.Mutable(entity) = nodes.size();
+    nodes.push_back(HierarchyNode{entity, INVALID_ID, INVALID_ID, 0});
+    MarkDirty(0);
+}
+
+void Hierarchy::Link(const EntityId child, const EntityId parent)
+{
+    auto& childLinks = links.Mutable(child);
+    childLinks.parent = parent;
+    childLinks.prevSibling = INVALID_ID;
+    childLinks.nextSibling = links[parent].firstChild;
+
+    if(childLinks.nextSibling != INVALID_ID)
+        links.Mutable(childLinks.nextSibling).prevSibling = child;
+    links.Mutable(parent).firstChild = child;
+}
+
+void Hierarchy::Unlink(const EntityId child)
+{
+    const Links childLinks = links[child];
+    if(childLinks.parent == INVALID_ID)
+        return;
+
+    if(childLinks.prevSibling != INVALID_ID)
+        links.Mutable(childLinks.prevSibling).nextSibling = childLinks.nextSibling;
+    else
+        links.Mutable(childLinks.parent).firstChild = childLinks.nextSibling;
+
+    if(childLinks.nextSibling != INVALID_ID)
+        links.Mutable(childLinks.nextSibling).prevSibling = childLinks.prevSibling;
+
+    auto& newLinks = links.Mutable(child);
+    newLinks.parent = INVALID_ID;
+    newLinks.prevSibling = INVALID_ID;
+    newLinks.nextSibling = INVALID_ID;
+}
+
+// Until the next sort parentIndex is the parent's current slot, so the sort can
+// remap it instead of looking every parent up
+void Hierarchy::MoveSubtree(const EntityId root, const uint32_t newDepth)
+{
+    auto& rootNode = nodes[slots[root]];
+    rootNode.parent = links[root].parent;
+    rootNode.parentIndex = rootNode.parent == INVALID_ID ? INVALID_ID : slots[rootNode.parent];
+    if(rootNode.depth == newDepth)
+        return;
+
+    MarkDirty(std::min(rootNode.depth, newDepth));
+    rootNode.depth = newDepth;
+    std::vector<EntityId> pending{root};
+    while(!pending.empty())
+    {
+        const EntityId parent = pending.back();
+        pending.pop_back();
+        const uint32_t depth = nodes[slots[parent]].depth + 1;
+        for(EntityId child = links[parent].firstChild; child != INVALID_ID; child = links[child].nextSibling)
+        {
+            nodes[slots[child]].depth = depth;
+            pending.push_back(child);
+        }
+    }
+}
+
+// Stable counting sort of everything from the first dirty depth on, nodes before
+// it have not moved since the last sort
+void Hierarchy::Sort() const
+{
+    if(dirtyDepth == INVALID_ID)
+        return;
+
+    // Edits never move a node at a depth below dirtyDepth, so that prefix is still in place
+    const uint32_t firstDepth = std::min<uint32_t>(dirtyDepth, depthStart.size());
+    const uint32_t from = std::min<uint32_t>(firstDepth < depthStart.size() ? depthStart[firstDepth] : 0, nodes.size());
+    uint32_t maxDepth = firstDepth;
+    for(uint32_t i = from; i < nodes.size(); i++)
+        maxDepth = std::max(maxDepth, nodes[i].depth);
+
+    depthStart.resize(maxDepth + 2);
+    std::fill(depthStart.begin() + firstDepth, depthStart.end(), 0);
+    for(uint32_t i = from; i < nodes.size(); i++)
+        depthStart[nodes[i].depth + 1]++;
+    depthStart[firstDepth] = from;
+    for(uint32_t depth = firstDepth + 1; depth < depthStart.size(); depth++)
+        depthStart[depth] += depthStart[depth - 1];
+
+    scratch.resize(nodes.size());
+    newIndex.resize(nodes.size() - from);
+    for(uint32_t i = from; i < nodes.size(); i++)
+    {
+        const uint32_t index = depthStart[nodes[i].depth]++;
+        newIndex[i - from] = index;
+        scratch[index] = nodes[i];
+    }
+    for(uint32_t depth = depthStart.size() - 1; depth > firstDepth; depth--)
+        depthStart[depth] = depthStart[depth - 1];
+    depthStart[firstDepth] = from;
+    depthStart.pop_back();
+
+    for(uint32_t i = from; i < nodes.size(); i++)
+    {
+        auto& node = nodes[i] = scratch[i];
+        slots.Mutable(node.entity) = i;
+        if(node.parentIndex != INVALID_ID && node.parentIndex >= from)
+            node.parentIndex = newIndex[node.parentIndex - from];
+    }
+    dirtyDepth = INVALID_ID;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "PagedArray.hpp"
+#include "Types.hpp"
+
+struct HierarchyNode
+{
+    EntityId entity = INVALID_ID;
+    EntityId parent = INVALID_ID;
+    uint32_t parentIndex = INVALID_ID;
+    uint32_t depth = 0;
+};
+
+// Parent/child relations kept in a dense array sorted by depth, so every parent
+// precedes its children and propagation is a single sweep over Nodes(). Edits only
+// touch the moved subtree and leave the array unsorted from the shallowest depth
+// they changed, the next Nodes() counting sorts that tail once for all of them.
+class Hierarchy
+{
+public:
+    void SetParent(const EntityId child, const EntityId parent)
+    {
+        ASSERT(child != parent && child < MAX_ENTITY_COUNT && parent < MAX_ENTITY_COUNT);
+        for(EntityId ancestor = parent; ancestor != INVALID_ID; ancestor = links[ancestor].parent)
+            ASSERT(ancestor != child);
+        Attach(child, parent);
+    }
+
+    void RemoveParent(const EntityId child);
+    void Remove(const EntityId entity);
+
+    bool Contains(const EntityId entity) const;
+    EntityId GetParent(const EntityId entity) const;
+    uint32_t GetDepth(const EntityId entity) const;
+    uint32_t IndexOf(const EntityId entity) const;
+    void ForEachChild(const EntityId entity, const std::function<void(EntityId)>& func) const;
+
+    const std::vector<HierarchyNode>& Nodes() const
+    {
+        Sort();
+        return nodes;
+    }
+
+    // Sorting lazily from a const reader is not thread safe, the ECS sorts after
+    // structural changes so systems reading Nodes() in parallel find it sorted
+    void Sort() const;
+
+    size_t ReservedBytes() const
+    {
+        return (nodes.capacity() + scratch.capacity()) * sizeof(HierarchyNode) +
+            (newIndex.capacity() + depthStart.capacity()) * sizeof(uint32_t) + links.ReservedBytes() + slots.ReservedBytes();
+    }
+
+private:
+    struct Links
+    {
+        EntityId parent = INVALID_ID;
+        EntityId firstChild = INVALID_ID;
+        EntityId nextSibling = INVALID_ID;
+        EntityId prevSibling = INVALID_ID;
+    };
+
+    // SetParent past its checks, which stay inline so ASSERT behaves as in the caller's build
+    void Attach(const EntityId child, const EntityId parent);
+    void Insert(const EntityId entity);
+    void MarkDirty(const uint32_t depth) { dirtyDepth = std::min(dirtyDepth, depth); }
+    void Link(const EntityId child, const EntityId parent);
+    void Unlink(const EntityId child);
+    void MoveSubtree(const EntityId root, const uint32_t newDepth);
+
+    mutable std::vector<HierarchyNode> nodes;
+    mutable std::vector<HierarchyNode> scratch;
+    mutable std::vector<uint32_t> newIndex;
+    mutable std::vector<uint32_t> depthStart; // first index of each depth as of the last sort
+    PagedArray<Links> links{MAX_ENTITY_COUNT};
+    // Index of each entity in nodes, kept apart from links so a sort writes less memory
+    mutable PagedArray<uint32_t> slots{MAX_ENTITY_COUNT, INVALID_ID};
+    mutable uint32_t dirtyDepth = INVALID_ID;
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <vector>
+#include "Types.hpp"
+
+// Fixed size array split into reference counted pages. Copying the array only
+// copies page pointers, a shared page is duplicated on the first write to it.
+// References returned by Mutable() are invalidated when the array is copied.
+template <typename T, uint32_t PAGE_SIZE = DEFAULT_PAGE_SIZE>
+class PagedArray
+{
+    using Page = std::array<T, PAGE_SIZE>;
+
+public:
+    class ConstIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        ConstIterator() = default;
+        ConstIterator(const PagedArray* array, const uint32_t index) : array(array), index(index) {}
+
+        const T& operator*() const { return (*array)[index]; }
+        const T* operator->() const { return &(*array)[index]; }
+        ConstIterator& operator++() { index++; return *this; }
+        ConstIterator operator++(int) { auto it = *this; index++; return it; }
+        bool operator==(const ConstIterator& other) const { return index == other.index; }
+        bool operator!=(const ConstIterator& other) const { return index != other.index; }
+
+    private:
+        const PagedArray* array = nullptr;
+        uint32_t index = 0;
+    };
+
+    struct ConstRange
+    {
+        ConstIterator first;
+        ConstIterator last;
+        ConstIterator begin() const { return first; }
+        ConstIterator end() const { return last; }
+    };
+
+    PagedArray(const uint32_t size = 0, const T& fill = T{})
+        : pages((size + PAGE_SIZE - 1) / PAGE_SIZE), size(size), fill(fill) {}
+
+    const T& operator[](const uint32_t index) const
+    {
+        const auto& page = pages[index / PAGE_SIZE];
+        return page ? (*page)[index % PAGE_SIZE] : fill;
+    }
+
+    T& Mutable(const uint32_t index)
+    {
+        auto& page = pages[index / PAGE_SIZE];
+        if(!page)
+        {
+            page = std::make_shared<Page>();
+            page->fill(fill);
+        }
+        else if(page.use_count() > 1)
+            page = std::make_shared<Page>(*page);
+
+        return (*page)[index % PAGE_SIZE];
+    }
+
+    // Contiguous writable run from index to the end of its page, at most count long
+    std::span<T> MutableChunk(const uint32_t index, const uint32_t count)
+    {
+        T* first = &Mutable(index);
+        return {first, std::min(count, PAGE_SIZE - index % PAGE_SIZE)};
+    }
+
+    // Contiguous run from index to the end of its page, at most count long.
+    // An unallocated page yields the fill value alone.
+    std::span<const T> Chunk(const uint32_t index, const uint32_t count) const
+    {
+        const auto& page = pages[index / PAGE_SIZE];
+        if(!page)
+            return {&fill, 1};
+        return {&(*page)[index % PAGE_SIZE], std::min(count, PAGE_SIZE - index % PAGE_SIZE)};
+    }
+
+    ConstIterator Iterator(const uint32_t index) const { return ConstIterator(this, index); }
+    ConstRange Range(const uint32_t from, const uint32_t to) const { return {Iterator(from), Iterator(to)}; }
+
+    uint32_t Size() const { return size; }
+    uint32_t PageCount() const { return pages.size(); }
+
+    uint32_t AllocatedPages() const
+    {
+        return std::count_if(pages.begin(), pages.end(), [](const auto& page){ return page != nullptr; });
+    }
+
+    uint32_t SharedPages() const
+    {
+        return std::count_if(pages.begin(), pages.end(), [](const auto& page){ return page.use_count() > 1; });
+    }
+
+    size_t ReservedBytes() const
+    {
+        return AllocatedPages() * sizeof(Page) + pages.capacity() * sizeof(std::shared_ptr<Page>);
+    }
+
+    static constexpr uint32_t PageSize() { return PAGE_SIZE; }
+
+private:
+    std::vector<std::shared_ptr<Page>> pages;
+    uint32_t size;
+    T fill;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+#include "ComponentManager.hpp"
+#include "Types.hpp"
+
+class IPrefabComponent
+{
+public:
+    virtual bool Fits(ComponentManager& compManager, const uint32_t count) const = 0;
+    virtual void Fill(ComponentManager& compManager, std::span<const EntityId> entities) const = 0;
+    virtual std::unique_ptr<IPrefabComponent> Clone() const = 0;
+    virtual ~IPrefabComponent() {};
+};
+
+template <typename Component>
+class PrefabComponent : public IPrefabComponent
+{
+public:
+    PrefabComponent(const Component& value) : value(value) {}
+
+    bool Fits(ComponentManager& compManager, const uint32_t count) const override
+    {
+        const auto& pool = compManager.GetComponentPool<Component>();
+        return pool.Size() + count <= pool.Capacity();
+    }
+
+    void Fill(ComponentManager& compManager, std::span<const EntityId> entities) const override
+    {
+        compManager.GetComponentPool<Component>().FillComponents(entities, value);
+    }
+
+    std::unique_ptr<IPrefabComponent> Clone() const override
+    {
+        return std::make_unique<PrefabComponent<Component>>(value);
+    }
+
+    Component value;
+};
+
+// Component values and the matching signature, built by ECS::CreatePrefab and
+// stamped out with ECS::Instantiate
+class Prefab
+{
+public:
+    Prefab() = default;
+
+    Prefab(const Prefab& other) : signature(other.signature)
+    {
+        for(const auto& component : other.components)
+            components.push_back(component->Clone());
+    }
+
+    Prefab(Prefab&&) = default;
+    Prefab& operator=(Prefab&&) = default;
+
+    template <typename Component>
+    std::optional<std::reference_wrapper<Component>> TryGet()
+    {
+        for(auto& component : components)
+            if(auto* typed = dynamic_cast<PrefabComponent<Component>*>(component.get()))
+                return {typed->value};
+        return {};
+    }
+
+    // Throws std::bad_optional_access when asserts are compiled out and the prefab lacks the component
+    template <typename Component>
+    Component& Get()
+    {
+        auto value = TryGet<Component>();
+        ASSERT(value.has_value());
+        return value.value().get();
+    }
+
+    const Signature& GetSignature() const { return signature; }
+
+private:
+    friend class ECS;
+
+    template <typename Component>
+    void Set(ComponentManager& compManager, const Component& value)
+    {
+        const auto compId = compManager.CompId<Component>();
+        ASSERT(!signature.test(compId));
+        signature.set(compId);
+        components.push_back(std::make_unique<PrefabComponent<Component>>(value));
+    }
+
+    Signature signature;
+    std::vector<std::unique_ptr<IPrefabComponent>> components;
+};
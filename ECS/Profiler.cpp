@@ -0,0 +1,130 @@
+#include "Profiler.hpp"
+#include <atomic>
+#include <fstream>
+#include "Stats.hpp"
+
+namespace
+{
+    const char* PhaseName(const ProfilePhase phase)
+    {
+        switch(phase)
+        {
+            case ProfilePhase::Update: return "Update";
+            case ProfilePhase::FixedUpdate: return "FixedUpdate";
+            case ProfilePhase::Render: return "Render";
+        }
+        return "";
+    }
+
+    void WriteEscaped(std::ostream& out, const std::string& text)
+    {
+        for(const char c : text)
+        {
+            if(c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+    }
+}
+
+Profiler::Profiler(const uint32_t frameCapacity)
+    : frames(frameCapacity), originNs(ReadNanoseconds())
+{
+    ASSERT(frameCapacity > 0);
+}
+
+Profiler::Profiler(const Profiler& other)
+    : frames(other.frames),
+      systemNames(other.systemNames),
+      frameCount(other.frameCount),
+      originNs(other.originNs)
+{
+}
+
+void Profiler::SetSystemName(const SystemId system, const char* mangledName)
+{
+    if(systemNames.size() <= system)
+        systemNames.resize(system + 1);
+    systemNames[system] = Demangle(mangledName);
+}
+
+const std::string& Profiler::GetSystemName(const SystemId system) const
+{
+    static const std::string unknown = "System";
+    return system < systemNames.size() ? systemNames[system] : unknown;
+}
+
+void Profiler::BeginFrame()
+{
+    std::lock_guard lock(recordMutex);
+    auto& frame = frames[frameCount % frames.size()];
+    frame.frame = frameCount;
+    frame.startNs = ReadNanoseconds();
+    frame.systems.clear();
+    frameCount++;
+}
+
+void Profiler::Record(const SystemProfile& profile)
+{
+    std::lock_guard lock(recordMutex);
+    if(frameCount == 0)
+        return;
+    frames[(frameCount - 1) % frames.size()].systems.push_back(profile);
+}
+
+uint32_t Profiler::ThreadIndex()
+{
+    static std::atomic<uint32_t> nextIndex{0};
+    thread_local const uint32_t index = nextIndex++;
+    return index;
+}
+
+uint32_t Profiler::StoredFrames() const
+{
+    return frameCount < frames.size() ? frameCount : frames.size();
+}
+
+const FrameProfile& Profiler::GetFrame(const uint32_t index) const
+{
+    ASSERT(index < StoredFrames());
+    return frames[(frameCount - StoredFrames() + index) % frames.size()];
+}
+
+void Profiler::WriteChromeTrace(std::ostream& out) const
+{
+    auto micros = [&](const uint64_t ns){ return (ns - originNs) / 1000.0; };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for(uint32_t i = 0; i < StoredFrames(); i++)
+    {
+        const auto& frame = GetFrame(i);
+        out << (first ? "" : ",") << "{\"name\":\"Frame " << frame.frame
+            << "\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":" << micros(frame.startNs) << "}";
+        first = false;
+
+        for(const auto& system : frame.systems)
+        {
+            out << ",{\"name\":\"";
+            WriteEscaped(out, GetSystemName(system.system));
+            out << "\",\"cat\":\"" << PhaseName(system.phase)
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << system.thread
+                << ",\"ts\":" << micros(system.startNs)
+                << ",\"dur\":" << system.durationNs / 1000.0
+                << ",\"args\":{\"frame\":" << frame.frame
+                << ",\"entities\":" << system.entities
+                << ",\"cycles\":" << system.cycles
+                << ",\"structuralChanges\":" << system.structuralChanges << "}}";
+        }
+    }
+    out << "]}";
+}
+
+bool Profiler::SaveChromeTrace(const std::string& path) const
+{
+    std::ofstream file(path);
+    if(!file)
+        return false;
+    WriteChromeTrace(file);
+    return static_cast<bool>(file);
+}
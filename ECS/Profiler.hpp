@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Clock.hpp"
+#include "Types.hpp"
+
+// Profiling is compiled in only with ECS_PROFILING, otherwise the macros expand to nothing
+#ifdef ECS_PROFILING
+#define ECS_PROFILE_FRAME() profiler.BeginFrame();
+#define ECS_PROFILE_SYSTEM(system, phase, entityCount) \
+    ProfileScope profileScope(profiler, system, phase, entityCount);
+#define ECS_PROFILE_STRUCTURAL_CHANGE() Profiler::CountStructuralChange();
+#else
+#define ECS_PROFILE_FRAME()
+#define ECS_PROFILE_SYSTEM(system, phase, entityCount)
+#define ECS_PROFILE_STRUCTURAL_CHANGE()
+#endif // ECS_PROFILING
+
+enum class ProfilePhase : uint8_t
+{
+    Update,
+    FixedUpdate,
+    Render
+};
+
+struct SystemProfile
+{
+    SystemId system;
+    ProfilePhase phase;
+    uint32_t thread;
+    uint32_t entities;
+    uint32_t structuralChanges;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint64_t cycles;
+};
+
+struct FrameProfile
+{
+    uint64_t frame = 0;
+    uint64_t startNs = 0;
+    std::vector<SystemProfile> systems;
+};
+
+// Keeps the last frameCapacity frames of per-system timings in a ring buffer
+class Profiler
+{
+public:
+    Profiler(const uint32_t frameCapacity = 256);
+    Profiler(const Profiler& other);
+    Profiler& operator=(const Profiler&) = delete;
+
+    void SetSystemName(const SystemId system, const char* mangledName);
+    const std::string& GetSystemName(const SystemId system) const;
+
+    void BeginFrame();
+    void Record(const SystemProfile& profile);
+
+    static void CountStructuralChange() { structuralChanges++; }
+    static uint32_t StructuralChanges() { return structuralChanges; }
+    static uint32_t ThreadIndex();
+
+    uint64_t FrameCount() const { return frameCount; }
+    uint32_t StoredFrames() const;
+    // 0 is the oldest stored frame
+    const FrameProfile& GetFrame(const uint32_t index) const;
+
+    // Chrome trace event JSON, opens in chrome://tracing and Perfetto
+    void WriteChromeTrace(std::ostream& out) const;
+    bool SaveChromeTrace(const std::string& path) const;
+
+private:
+    inline static thread_local uint32_t structuralChanges = 0;
+
+    std::vector<FrameProfile> frames;
+    std::vector<std::string> systemNames;
+    uint64_t frameCount = 0;
+    uint64_t originNs;
+    std::mutex recordMutex;
+};
+
+class ProfileScope
+{
+public:
+    ProfileScope(Profiler& profiler, const SystemId system, const ProfilePhase phase, const uint32_t entities)
+        : profiler(profiler),
+          profile{system, phase, Profiler::ThreadIndex(), entities, Profiler::StructuralChanges(), ReadNanoseconds(), 0, ReadCycleCounter()} {}
+
+    ~ProfileScope()
+    {
+        profile.cycles = ReadCycleCounter() - profile.cycles;
+        profile.durationNs = ReadNanoseconds() - profile.startNs;
+        profile.structuralChanges = Profiler::StructuralChanges() - profile.structuralChanges;
+        profiler.Record(profile);
+    }
+
+private:
+    Profiler& profiler;
+    SystemProfile profile;
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "Types.hpp"
+
+class IResource
+{
+public:
+    virtual std::unique_ptr<IResource> Clone() const = 0;
+    virtual ~IResource() {};
+};
+
+template <typename Resource>
+class ResourceHolder : public IResource
+{
+public:
+    template <typename... ARGS>
+    ResourceHolder(ARGS&&... args) : value(std::forward<ARGS>(args)...) {}
+
+    std::unique_ptr<IResource> Clone() const override
+    {
+        if constexpr (std::is_copy_constructible_v<Resource>)
+            return std::make_unique<ResourceHolder<Resource>>(value);
+        else
+        {
+            ASSERT(false);
+            return nullptr;
+        }
+    }
+
+    Resource value;
+};
+
+// Declared by systems, lets a scheduler tell which systems may touch a resource at the same time
+struct ResourceAccess
+{
+    ResourceSignature reads;
+    ResourceSignature writes;
+
+    template <typename Resource>
+    void Read();
+
+    template <typename Resource>
+    void Write();
+};
+
+// World wide singletons, each type gets a fixed slot the first time it is used
+class ResourceManager
+{
+public:
+    template <typename Resource>
+    static ResourceId ResId()
+    {
+        static const ResourceId id = nextResourceId++;
+        ASSERT(id < MAX_RESOURCE_COUNT);
+        return id;
+    }
+
+    ResourceManager() = default;
+
+    ResourceManager(const ResourceManager& other)
+    {
+        for(ResourceId id = 0; id < MAX_RESOURCE_COUNT; id++)
+            if(other.resources[id])
+                resources[id] = other.resources[id]->Clone();
+    }
+
+    ResourceManager& operator=(const ResourceManager&) = delete;
+
+    template <typename Resource, typename... ARGS>
+    Resource& SetResource(ARGS&&... args)
+    {
+        auto holder = std::make_unique<ResourceHolder<Resource>>(std::forward<ARGS>(args)...);
+        auto& value = holder->value;
+        resources[ResId<Resource>()] = std::move(holder);
+        return value;
+    }
+
+    template <typename Resource>
+    Resource& GetResource()
+    {
+        ASSERT(HasResource<Resource>());
+        return static_cast<ResourceHolder<Resource>*>(resources[ResId<Resource>()].get())->value;
+    }
+
+    template <typename Resource>
+    const Resource& GetResource() const
+    {
+        ASSERT(HasResource<Resource>());
+        return static_cast<const ResourceHolder<Resource>*>(resources[ResId<Resource>()].get())->value;
+    }
+
+    template <typename Resource>
+    bool HasResource() const
+    {
+        return resources[ResId<Resource>()] != nullptr;
+    }
+
+    template <typename Resource>
+    void RemoveResource()
+    {
+        ASSERT(HasResource<Resource>());
+        resources[ResId<Resource>()].reset();
+    }
+
+private:
+    inline static std::atomic<ResourceId> nextResourceId = 0;
+    std::array<std::unique_ptr<IResource>, MAX_RESOURCE_COUNT> resources;
+};
+
+template <typename Resource>
+void ResourceAccess::Read()
+{
+    reads.set(ResourceManager::ResId<Resource>());
+}
+
+template <typename Resource>
+void ResourceAccess::Write()
+{
+    writes.set(ResourceManager::ResId<Resource>());
+}
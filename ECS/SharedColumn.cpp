@@ -0,0 +1,114 @@
+#include "SharedColumn.hpp"
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace
+{
+
+constexpr uint64_t ALIGNMENT = 64;
+
+uint64_t Align(const uint64_t offset)
+{
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+} // namespace
+
+SharedSegment::SharedSegment(SharedSegment&& other) noexcept
+    : name(std::move(other.name)), data(std::exchange(other.data, nullptr)),
+      size(std::exchange(other.size, 0)), owner(std::exchange(other.owner, false)) {}
+
+SharedSegment& SharedSegment::operator=(SharedSegment&& other) noexcept
+{
+    if(this != &other)
+    {
+        Reset();
+        name = std::move(other.name);
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        owner = std::exchange(other.owner, false);
+    }
+    return *this;
+}
+
+SharedSegment::~SharedSegment()
+{
+    Reset();
+}
+
+void SharedSegment::Reset()
+{
+    if(data)
+        munmap(data, size);
+    if(owner)
+        shm_unlink(name.c_str());
+    data = nullptr;
+    size = 0;
+    owner = false;
+}
+
+SharedSegment SharedSegment::Create(const std::string& name, const size_t bytes)
+{
+    SharedSegment segment;
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if(fd < 0)
+        return segment;
+
+    void* mapped = MAP_FAILED;
+    if(ftruncate(fd, bytes) == 0)
+        mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        return segment;
+    }
+
+    segment.name = name;
+    segment.data = static_cast<std::byte*>(mapped);
+    segment.size = bytes;
+    segment.owner = true;
+    return segment;
+}
+
+SharedSegment SharedSegment::Open(const std::string& name)
+{
+    SharedSegment segment;
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0)
+        return segment;
+
+    struct stat info;
+    void* mapped = MAP_FAILED;
+    if(fstat(fd, &info) == 0 && info.st_size > 0)
+        mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED)
+        return segment;
+
+    segment.name = name;
+    segment.data = static_cast<std::byte*>(mapped);
+    segment.size = info.st_size;
+    return segment;
+}
+
+SharedSegment CreateSharedColumn(const std::string& name, const uint64_t typeHash, const uint32_t componentSize, const uint32_t capacity)
+{
+    const uint64_t entitiesOffset = Align(sizeof(SharedColumnHeader));
+    const uint64_t componentsOffset = Align(entitiesOffset + uint64_t(capacity) * sizeof(EntityId));
+    SharedSegment segment = SharedSegment::Create(name, Align(componentsOffset + uint64_t(capacity) * componentSize));
+    if(!segment)
+        return segment;
+
+    auto* header = new(segment.Data()) SharedColumnHeader;
+    header->typeHash = typeHash;
+    header->componentSize = componentSize;
+    header->capacity = capacity;
+    header->entitiesOffset = entitiesOffset;
+    header->componentsOffset = componentsOffset;
+    return segment;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+#include "Types.hpp"
+
+// Layout shared between the exporting process and readers. Depends on nothing
+// but Types.hpp so out-of-process tools only need this header and SharedColumn.cpp.
+//
+// The segment holds one component column: this header, the dense entity ids and
+// the dense components, each 64 byte aligned. sequence is a seqlock, odd while
+// the writer is copying, so readers never block the simulation and retry instead.
+struct SharedColumnHeader
+{
+    static constexpr uint32_t MAGIC = 0x43534345; // "ECSC"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint64_t typeHash = 0;
+    uint32_t componentSize = 0;
+    uint32_t capacity = 0;
+    uint64_t entitiesOffset = 0;
+    uint64_t componentsOffset = 0;
+
+    alignas(64) std::atomic<uint64_t> sequence = 0;
+    std::atomic<uint64_t> frame = 0;
+    std::atomic<uint32_t> count = 0;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Seqlock has to work across processes");
+
+// Stable across processes built by the same compiler, unlike std::hash
+template <typename Component>
+uint64_t SharedTypeHash()
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for(const char* c = typeid(Component).name(); *c; c++)
+        hash = (hash ^ uint8_t(*c)) * 0x100000001b3;
+    return hash;
+}
+
+// POSIX shared memory object mapped into this process. The creator unlinks it on destruction.
+class SharedSegment
+{
+public:
+    SharedSegment() = default;
+    SharedSegment(SharedSegment&& other) noexcept;
+    SharedSegment& operator=(SharedSegment&& other) noexcept;
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+    ~SharedSegment();
+
+    // Empty segment on failure
+    static SharedSegment Create(const std::string& name, const size_t bytes);
+    static SharedSegment Open(const std::string& name);
+
+    std::byte* Data() const { return data; }
+    size_t Size() const { return size; }
+    explicit operator bool() const { return data != nullptr; }
+
+private:
+    void Reset();
+
+    std::string name;
+    std::byte* data = nullptr;
+    size_t size = 0;
+    bool owner = false;
+};
+
+// Creates the segment for a column of capacity components and writes its header
+SharedSegment CreateSharedColumn(const std::string& name, const uint64_t typeHash, const uint32_t componentSize, const uint32_t capacity);
+
+template <typename Component>
+class SharedColumnReader
+{
+    static_assert(std::is_trivially_copyable_v<Component>, "Shared columns hold raw bytes");
+
+public:
+    SharedColumnReader(const std::string& name) : segment(SharedSegment::Open(name))
+    {
+        if(!segment || segment.Size() < sizeof(SharedColumnHeader))
+            return;
+
+        const auto* candidate = reinterpret_cast<const SharedColumnHeader*>(segment.Data());
+        if(candidate->magic != SharedColumnHeader::MAGIC || candidate->version != SharedColumnHeader::VERSION ||
+           candidate->typeHash != SharedTypeHash<Component>() || candidate->componentSize != sizeof(Component) ||
+           candidate->componentsOffset + uint64_t(candidate->capacity) * sizeof(Component) > segment.Size())
+            return;
+        header = candidate;
+    }
+
+    bool Valid() const { return header != nullptr; }
+
+    // Hands out the mapped arrays without copying. They may be overwritten while
+    // func runs, so whatever func derived is only usable when Read returns true.
+    template <typename Func>
+    bool Read(Func func) const
+    {
+        ASSERT(Valid());
+        const uint64_t before = header->sequence.load(std::memory_order_acquire);
+        if(before & 1)
+            return false;
+
+        const uint32_t count = std::min(header->count.load(std::memory_order_relaxed), header->capacity);
+        const auto* entities = reinterpret_cast<const EntityId*>(segment.Data() + header->entitiesOffset);
+        const auto* components = reinterpret_cast<const Component*>(segment.Data() + header->componentsOffset);
+        func(header->frame.load(std::memory_order_relaxed), std::span(entities, count), std::span(components, count));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header->sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Consistent copy of the column, gives up after attempts torn reads
+    bool Snapshot(std::vector<EntityId>& entities, std::vector<Component>& components, uint64_t& frame,
+                  const uint32_t attempts = 64) const
+    {
+        for(uint32_t attempt = 0; attempt < attempts; attempt++)
+        {
+            const bool consistent = Read([&](uint64_t publishedFrame, std::span<const EntityId> ids, std::span<const Component> values)
+            {
+                frame = publishedFrame;
+                entities.assign(ids.begin(), ids.end());
+                components.assign(values.begin(), values.end());
+            });
+            if(consistent)
+                return true;
+        }
+        return false;
+    }
+
+    // Bumped twice per publish, readers can skip frames they already saw
+    uint64_t Sequence() const { return header->sequence.load(std::memory_order_acquire); }
+
+private:
+    SharedSegment segment;
+    const SharedColumnHeader* header = nullptr;
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <deque>
+#include <memory>
+#include <span>
+#include <typeinfo>
+#include <vector>
+#include "Component.hpp"
+#include "PagedArray.hpp"
+#include "Stats.hpp"
+#include "Types.hpp"
+
+// Flyweight storage, entities with equal values point at one reference counted
+// copy. Values are immutable, SetComponent moves the entity to another value.
+// Entities are kept grouped by value so systems can hoist the shared data out of
+// their loops with ForEachGroup. Lookup is a linear scan over distinct values,
+// meant for a handful to a few hundred of them. Returned references stay valid
+// while some entity still holds the value.
+template <typename Component>
+class SharedComponentPool : public IComponentPool
+{
+public:
+    SharedComponentPool(ComponentId MAX_SIZE = MAX_ENTITY_COUNT) : capacity(MAX_SIZE) {}
+
+    const Component& AddComponent(const EntityId entity, const Component& value)
+    {
+        ASSERT(size < capacity && entity < MAX_ENTITY_COUNT && !Contains(entity));
+        const uint32_t valueId = Acquire(value);
+        Join(entity, valueId);
+        size++;
+        return values[valueId];
+    }
+
+    const Component& SetComponent(const EntityId entity, const Component& value)
+    {
+        ASSERT(Contains(entity));
+        const uint32_t valueId = Acquire(value);
+        if(valueId == valueOf[entity])
+            return values[valueId];
+
+        Leave(entity);
+        Join(entity, valueId);
+        return values[valueId];
+    }
+
+    const Component& GetComponent(const EntityId entity) const
+    {
+        ASSERT(Contains(entity));
+        return values[valueOf[entity]];
+    }
+
+    bool TryDeleteComponent(const EntityId entity) override
+    {
+        if(!Contains(entity))
+            return false;
+
+        DeleteComponent(entity);
+        return true;
+    }
+
+    void DeleteComponent(const EntityId entity)
+    {
+        ASSERT(Contains(entity));
+        Leave(entity);
+        valueOf.Mutable(entity) = INVALID_ID;
+        size--;
+    }
+
+    bool Contains(const EntityId entity) const
+    {
+        return entity < MAX_ENTITY_COUNT && valueOf[entity] != INVALID_ID;
+    }
+
+    ComponentId Size() const { return size; }
+    ComponentId Capacity() const { return capacity; }
+    uint32_t ValueCount() const { return values.size() - freeValues.size(); }
+
+    // Calls func(value, entities) once per distinct value
+    template <typename Func>
+    void ForEachGroup(Func func) const
+    {
+        for(uint32_t valueId = 0; valueId < values.size(); valueId++)
+            if(!groups[valueId].empty())
+                func(values[valueId], std::span<const EntityId>(groups[valueId]));
+    }
+
+    std::unique_ptr<IComponentPool> Clone() const override
+    {
+        return std::make_unique<SharedComponentPool<Component>>(*this);
+    }
+
+    PoolStats GetStats() const override
+    {
+        PoolStats stats;
+        stats.name = Demangle(typeid(Component).name());
+        stats.live = size;
+        stats.capacity = capacity;
+        stats.componentSize = sizeof(Component);
+        stats.bytesReserved = values.size() * sizeof(Component) + freeValues.capacity() * sizeof(uint32_t) +
+                              valueOf.ReservedBytes() + slotOf.ReservedBytes();
+        stats.bytesUsed = ValueCount() * sizeof(Component) + size * (sizeof(EntityId) + 2 * sizeof(uint32_t));
+        for(const auto& group : groups)
+            stats.bytesReserved += sizeof(group) + group.capacity() * sizeof(EntityId);
+        stats.sharedPages = valueOf.SharedPages() + slotOf.SharedPages();
+        return stats;
+    }
+
+private:
+    uint32_t Acquire(const Component& value)
+    {
+        for(uint32_t valueId = 0; valueId < values.size(); valueId++)
+            if(!groups[valueId].empty() && values[valueId] == value)
+                return valueId;
+
+        if(freeValues.empty())
+        {
+            values.push_back(value);
+            groups.emplace_back();
+            return values.size() - 1;
+        }
+
+        const uint32_t valueId = freeValues.back();
+        freeValues.pop_back();
+        values[valueId] = value;
+        return valueId;
+    }
+
+    void Join(const EntityId entity, const uint32_t valueId)
+    {
+        valueOf.Mutable(entity) = valueId;
+        slotOf.Mutable(entity) = groups[valueId].size();
+        groups[valueId].push_back(entity);
+    }
+
+    void Leave(const EntityId entity)
+    {
+        const uint32_t valueId = valueOf[entity];
+        auto& group = groups[valueId];
+        const uint32_t slot = slotOf[entity];
+        group[slot] = group.back();
+        slotOf.Mutable(group[slot]) = slot;
+        group.pop_back();
+        if(group.empty())
+            freeValues.push_back(valueId);
+    }
+
+    std::deque<Component> values; // never reallocates, unlike a vector
+    std::vector<std::vector<EntityId>> groups;
+    std::vector<uint32_t> freeValues;
+    PagedArray<uint32_t> valueOf{MAX_ENTITY_COUNT, INVALID_ID};
+    PagedArray<uint32_t> slotOf{MAX_ENTITY_COUNT, INVALID_ID};
+    ComponentId capacity;
+    ComponentId size = 0;
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ECS.hpp"
+#include "SharedColumn.hpp"
+#include "Types.hpp"
+
+class IColumnExport
+{
+public:
+    // False if the pool outgrew the segment and only part of it was published
+    virtual bool Publish(ECS& ecs, const uint64_t frame) = 0;
+    virtual ~IColumnExport() {};
+};
+
+template <typename Component>
+class ColumnExport : public IColumnExport
+{
+    static_assert(std::is_trivially_copyable_v<Component>, "Shared columns hold raw bytes");
+
+public:
+    ColumnExport(SharedSegment segment) : segment(std::move(segment)) {}
+
+    bool Publish(ECS& ecs, const uint64_t frame) override
+    {
+        auto* header = reinterpret_cast<SharedColumnHeader*>(segment.Data());
+        auto* entities = reinterpret_cast<EntityId*>(segment.Data() + header->entitiesOffset);
+        auto* components = reinterpret_cast<Component*>(segment.Data() + header->componentsOffset);
+        const auto& pool = std::as_const(ecs.GetComponentPool<Component>());
+        const ComponentId count = std::min<ComponentId>(pool.Size(), header->capacity);
+
+        const uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+        header->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        pool.ForEachChunk([&](ComponentId first, std::span<const EntityId> ids, std::span<const Component> values)
+        {
+            if(first >= count)
+                return;
+            const size_t length = std::min<size_t>(ids.size(), count - first);
+            std::memcpy(entities + first, ids.data(), length * sizeof(EntityId));
+            std::memcpy(components + first, values.data(), length * sizeof(Component));
+        });
+        header->count.store(count, std::memory_order_relaxed);
+        header->frame.store(frame, std::memory_order_relaxed);
+
+        header->sequence.store(sequence + 2, std::memory_order_release);
+        return count == pool.Size();
+    }
+
+private:
+    SharedSegment segment;
+};
+
+// Mirrors selected component pools into POSIX shared memory so local tools can
+// map them read only. Publish() copies each dense column once under a seqlock,
+// it never waits on readers, readers see whole frames or retry.
+class SharedMemoryExporter
+{
+public:
+    // capacity defaults to the pool's, false if the segment could not be created
+    template <typename Component>
+    bool Export(ECS& ecs, const std::string& name, uint32_t capacity = 0)
+    {
+        if(capacity == 0)
+            capacity = ecs.GetComponentPool<Component>().Capacity();
+
+        SharedSegment segment = CreateSharedColumn(name, SharedTypeHash<Component>(), sizeof(Component), capacity);
+        if(!segment)
+            return false;
+        exports.push_back(std::make_unique<ColumnExport<Component>>(std::move(segment)));
+        return true;
+    }
+
+    // Call once per frame after the systems ran. Columns that outgrew their
+    // capacity publish their first capacity components, then this returns false.
+    bool Publish(ECS& ecs)
+    {
+        frame++;
+        bool complete = true;
+        for(const auto& column : exports)
+            complete &= column->Publish(ecs, frame);
+        return complete;
+    }
+
+    uint64_t Frame() const { return frame; }
+
+private:
+    std::vector<std::unique_ptr<IColumnExport>> exports;
+    uint64_t frame = 0;
+};
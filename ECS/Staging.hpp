@@ -0,0 +1,73 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "ComponentManager.hpp"
+#include "EntityAllocator.hpp"
+#include "PagedArray.hpp"
+#include "Types.hpp"
+
+class IStagedComponents
+{
+public:
+    virtual void Apply(ComponentManager& compManager, PagedArray<Signature>& signatures, std::vector<EntityId>& changed) = 0;
+    virtual ~IStagedComponents() {};
+};
+
+template <typename Component>
+class StagedComponents : public IStagedComponents
+{
+public:
+    void Add(const EntityId entity, Component&& value)
+    {
+        entities.push_back(entity);
+        values.push_back(std::move(value));
+    }
+
+    void Apply(ComponentManager& compManager, PagedArray<Signature>& signatures, std::vector<EntityId>& changed) override
+    {
+        auto& pool = compManager.GetComponentPool<Component>();
+        const auto compId = compManager.CompId<Component>();
+        for(size_t i = 0; i < entities.size(); i++)
+        {
+            pool.AddComponent(entities[i]) = std::move(values[i]);
+            signatures.Mutable(entities[i]).set(compId);
+        }
+        changed.insert(changed.end(), entities.begin(), entities.end());
+        entities.clear();
+        values.clear();
+    }
+
+private:
+    std::vector<EntityId> entities;
+    std::vector<Component> values;
+};
+
+// Structural changes made by one worker thread. Entity ids are handed out right
+// away, components are buffered here until ECS::FlushStages() merges them on
+// the main thread. A stage must only be used by one thread at a time.
+class ComponentStage
+{
+public:
+    ComponentStage(ComponentManager& compManager, EntityAllocator& entityAllocator)
+        : compManager(compManager), entityAllocator(entityAllocator) {}
+
+    EntityId CreateEntity() { return entityAllocator.Create(); }
+
+    template <typename Component, typename... ARGS>
+    void AddComponent(const EntityId entity, ARGS&&... args)
+    {
+        auto& staged = stagedComponents[compManager.CompId<Component>()];
+        if(!staged)
+            staged = std::make_unique<StagedComponents<Component>>();
+        static_cast<StagedComponents<Component>&>(*staged).Add(entity, Component(std::forward<ARGS>(args)...));
+    }
+
+private:
+    friend class ECS;
+
+    const ComponentManager& compManager;
+    EntityAllocator& entityAllocator;
+    std::array<std::unique_ptr<IStagedComponents>, MAX_COMPONENT_COUNT> stagedComponents;
+};
@@ -0,0 +1,69 @@
+#include "Stats.hpp"
+#include <cstdio>
+#ifdef __GNUG__
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+std::string Demangle(const char* mangledName)
+{
+#ifdef __GNUG__
+    int status = 0;
+    char* name = abi::__cxa_demangle(mangledName, nullptr, nullptr, &status);
+    if(status == 0 && name)
+    {
+        std::string demangled(name);
+        std::free(name);
+        return demangled;
+    }
+#endif
+    return mangledName;
+}
+
+size_t ECSStats::TotalBytes() const
+{
+    size_t total = entityBytes + hierarchyBytes;
+    for(const auto& pool : pools)
+        total += pool.bytesReserved;
+    for(const auto& system : systems)
+        total += system.bytesReserved;
+    return total;
+}
+
+std::string ECSStats::ToString() const
+{
+    std::string text;
+    char line[256];
+    auto kib = [](const size_t bytes){ return bytes / 1024.0; };
+
+    std::snprintf(line, sizeof(line), "entities: %u alive, %.1f KiB\nhierarchy: %.1f KiB\n",
+        aliveEntities, kib(entityBytes), kib(hierarchyBytes));
+    text += line;
+
+    text += "pools:\n";
+    for(const auto& pool : pools)
+    {
+        std::snprintf(line, sizeof(line), "  %-32s %8u / %-8u %10.1f KiB reserved %10.1f KiB used %5.1f%% fragmented\n",
+            pool.name.c_str(), pool.live, pool.capacity, kib(pool.bytesReserved), kib(pool.bytesUsed),
+            pool.Fragmentation() * 100.0);
+        text += line;
+    }
+
+    text += "systems:\n";
+    for(const auto& system : systems)
+    {
+        std::snprintf(line, sizeof(line), "  %-32s %8u entities %10.1f KiB",
+            system.name.c_str(), system.entities, kib(system.bytesReserved));
+        text += line;
+        if(system.passFrames > 0)
+        {
+            std::snprintf(line, sizeof(line), " %6u frames / %.3f s per pass", system.passFrames, system.passSeconds);
+            text += line;
+        }
+        text += "\n";
+    }
+
+    std::snprintf(line, sizeof(line), "total: %.1f KiB\n", kib(TotalBytes()));
+    text += line;
+    return text;
+}
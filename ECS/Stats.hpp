@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Types.hpp"
+
+std::string Demangle(const char* mangledName);
+
+struct PoolStats
+{
+    std::string name;
+    ComponentId live = 0;
+    ComponentId capacity = 0;
+    size_t componentSize = 0;
+    size_t bytesReserved = 0;
+    size_t bytesUsed = 0;
+    uint32_t sharedPages = 0;
+
+    // Share of reserved bytes that hold no live data
+    double Fragmentation() const
+    {
+        return bytesReserved == 0 ? 0.0 : 1.0 - static_cast<double>(bytesUsed) / bytesReserved;
+    }
+};
+
+struct SystemStats
+{
+    std::string name;
+    uint32_t entities = 0;
+    size_t bytesReserved = 0;
+    // Time sliced systems only, how long the last full pass over all entities took
+    uint32_t passFrames = 0;
+    float passSeconds = 0.0f;
+};
+
+struct ECSStats
+{
+    uint32_t aliveEntities = 0;
+    size_t entityBytes = 0;
+    size_t hierarchyBytes = 0;
+    std::vector<PoolStats> pools;
+    std::vector<SystemStats> systems;
+
+    size_t TotalBytes() const;
+    std::string ToString() const;
+};
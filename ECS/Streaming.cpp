@@ -0,0 +1,408 @@
+#include "Streaming.hpp"
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+
+constexpr char MAGIC[4] = {'E', 'C', 'S', 'R'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t ALIGNMENT = 16;
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t region;
+    uint32_t entityCount;
+    uint32_t columnCount;
+    uint32_t reserved[3];
+};
+
+struct ColumnHeader
+{
+    uint64_t typeHash;
+    uint32_t componentSize;
+    uint32_t rowCount;
+};
+
+class Writer
+{
+public:
+    void Append(const void* data, const size_t size)
+    {
+        const auto* first = static_cast<const std::byte*>(data);
+        bytes.insert(bytes.end(), first, first + size);
+    }
+
+    void Align() { bytes.resize((bytes.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT); }
+
+    std::vector<std::byte> bytes;
+};
+
+class Reader
+{
+public:
+    Reader(std::span<const std::byte> bytes) : bytes(bytes) {}
+
+    bool Read(void* data, const size_t size)
+    {
+        if(offset + size > bytes.size())
+            return false;
+        std::memcpy(data, bytes.data() + offset, size);
+        offset += size;
+        return true;
+    }
+
+    void Align() { offset = std::min(bytes.size(), (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT); }
+
+    // Sizes come from the file, check them before allocating anything
+    bool Fits(const uint64_t count, const uint64_t size) const
+    {
+        return size == 0 || count <= (bytes.size() - offset) / size;
+    }
+
+private:
+    std::span<const std::byte> bytes;
+    size_t offset = 0;
+};
+
+} // namespace
+
+std::vector<std::byte> RegionBlock::Serialize(const uint32_t region) const
+{
+    Writer writer;
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.region = region;
+    header.entityCount = entities.size();
+    header.columnCount = columns.size();
+    writer.Append(&header, sizeof(header));
+    writer.Append(entities.data(), entities.size() * sizeof(EntityId));
+    writer.Append(parents.data(), parents.size() * sizeof(EntityId));
+    writer.Align();
+
+    for(const auto& column : columns)
+    {
+        const ColumnHeader columnHeader{column.typeHash, column.componentSize, uint32_t(column.rows.size())};
+        writer.Append(&columnHeader, sizeof(columnHeader));
+        writer.Append(column.rows.data(), column.rows.size() * sizeof(uint32_t));
+        writer.Align();
+        writer.Append(column.data.data(), column.data.size());
+        writer.Align();
+    }
+    return std::move(writer.bytes);
+}
+
+bool RegionBlock::Deserialize(std::span<const std::byte> bytes)
+{
+    Reader reader(bytes);
+    FileHeader header;
+    if(!reader.Read(&header, sizeof(header)) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+       header.version != VERSION)
+        return false;
+
+    if(!reader.Fits(header.entityCount, 2 * sizeof(EntityId)) || !reader.Fits(header.columnCount, sizeof(ColumnHeader)))
+        return false;
+    entities.resize(header.entityCount);
+    parents.resize(header.entityCount);
+    if(!reader.Read(entities.data(), entities.size() * sizeof(EntityId)) ||
+       !reader.Read(parents.data(), parents.size() * sizeof(EntityId)))
+        return false;
+    reader.Align();
+
+    columns.resize(header.columnCount);
+    for(auto& column : columns)
+    {
+        ColumnHeader columnHeader;
+        if(!reader.Read(&columnHeader, sizeof(columnHeader)) || columnHeader.rowCount > header.entityCount ||
+           !reader.Fits(columnHeader.rowCount, uint64_t(sizeof(uint32_t)) + columnHeader.componentSize))
+            return false;
+
+        column.typeHash = columnHeader.typeHash;
+        column.componentSize = columnHeader.componentSize;
+        column.rows.resize(columnHeader.rowCount);
+        column.data.resize(size_t(columnHeader.rowCount) * columnHeader.componentSize);
+        if(!reader.Read(column.rows.data(), column.rows.size() * sizeof(uint32_t)))
+            return false;
+        reader.Align();
+        if(!reader.Read(column.data.data(), column.data.size()))
+            return false;
+        reader.Align();
+
+        for(const uint32_t row : column.rows)
+            if(row >= header.entityCount)
+                return false;
+    }
+    return true;
+}
+
+RegionStreamer::RegionStreamer()
+{
+    Track<Region>();
+    worker = std::thread(&RegionStreamer::IoWorker, this);
+}
+
+// Gathered entities are already gone from the world, so queued writes and whatever
+// a half done unload gathered are written before the worker stops. Reads are dropped.
+RegionStreamer::~RegionStreamer()
+{
+    for(auto& transfer : unloading)
+        if(!transfer->block.entities.empty())
+            Submit(std::move(transfer));
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void RegionStreamer::Unload(ECS& ecs, const uint32_t region, const std::string& path)
+{
+    ASSERT(GetState(region) == RegionState::Resident);
+
+    auto transfer = std::make_unique<Transfer>();
+    transfer->region = region;
+    transfer->path = path;
+    transfer->write = true;
+    for(const auto& component : tracked)
+        transfer->block.columns.push_back({component->TypeHash(), component->Size(), {}, {}});
+
+    // Candidates and their parents are taken now, the hierarchy loses links as entities are destroyed
+    const auto& regions = std::as_const(ecs.GetComponentPool<Region>());
+    std::unordered_set<EntityId> members;
+    for(const EntityId entity : regions.Entities())
+        if(regions.GetComponent(entity).id == region)
+            members.insert(entity);
+    for(const EntityId entity : regions.Entities())
+    {
+        if(!members.contains(entity))
+            continue;
+        const EntityId parent = ecs.GetParent(entity);
+        transfer->candidates.push_back(entity);
+        transfer->candidateParents.push_back(members.contains(parent) ? parent : INVALID_ID);
+    }
+
+    states[region] = RegionState::Unloading;
+    unloading.push_back(std::move(transfer));
+}
+
+void RegionStreamer::Load(const uint32_t region, const std::string& path, std::function<void(const EntityRemap&)> onLoaded)
+{
+    // A region this streamer never unloaded counts as resident, loading it from a shipped file is fine
+    const RegionState state = GetState(region);
+    ASSERT(state == RegionState::Resident || state == RegionState::Unloaded || state == RegionState::Failed);
+
+    auto transfer = std::make_unique<Transfer>();
+    transfer->region = region;
+    transfer->path = path;
+    transfer->onLoaded = std::move(onLoaded);
+    states[region] = RegionState::Reading;
+    Submit(std::move(transfer));
+}
+
+RegionState RegionStreamer::GetState(const uint32_t region) const
+{
+    const auto it = states.find(region);
+    return it == states.end() ? RegionState::Resident : it->second;
+}
+
+void RegionStreamer::Sync(ECS& ecs, const uint32_t budgetMicroseconds)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::microseconds(budgetMicroseconds);
+
+    std::deque<std::unique_ptr<Transfer>> done;
+    {
+        std::lock_guard lock(mutex);
+        done.swap(finished);
+    }
+    for(auto& transfer : done)
+    {
+        inFlight--;
+        if(transfer->write && !transfer->failed)
+            states[transfer->region] = RegionState::Unloaded;
+        else if(!transfer->write && transfer->failed)
+            states[transfer->region] = RegionState::Failed;
+        else
+        {
+            // Loaded, or a write that failed and has to be merged back from memory
+            transfer->cursor = 0;
+            states[transfer->region] = RegionState::Merging;
+            merging.push_back(std::move(transfer));
+        }
+    }
+
+    uint32_t processed = 0;
+    auto spent = [&](){ return processed > 0 && Clock::now() >= deadline; };
+    while(!unloading.empty() && !spent())
+    {
+        if(GatherStep(ecs, *unloading.front()))
+        {
+            states[unloading.front()->region] = RegionState::Writing;
+            Submit(std::move(unloading.front()));
+            unloading.pop_front();
+        }
+        processed++;
+    }
+
+    while(!merging.empty() && !spent())
+    {
+        Transfer& transfer = *merging.front();
+        if(MergeStep(ecs, transfer))
+        {
+            states[transfer.region] = RegionState::Resident;
+            if(transfer.onLoaded)
+                transfer.onLoaded(transfer.remap);
+            merging.pop_front();
+        }
+        processed++;
+    }
+}
+
+bool RegionStreamer::GatherStep(ECS& ecs, Transfer& transfer)
+{
+    if(transfer.cursor == transfer.candidates.size())
+        return true;
+
+    const uint32_t candidate = transfer.cursor++;
+    const EntityId entity = transfer.candidates[candidate];
+    const auto region = std::as_const(ecs).TryGetComponent<Region>(entity);
+    // Left the region or was destroyed since Unload(), handles to it will remap to INVALID_ID
+    if(region && region->get().id == transfer.region)
+    {
+        auto& block = transfer.block;
+        const uint32_t row = block.entities.size();
+        block.entities.push_back(entity);
+        block.parents.push_back(transfer.candidateParents[candidate]);
+        for(size_t i = 0; i < tracked.size(); i++)
+            if(tracked[i]->Gather(ecs, entity, block.columns[i].data))
+                block.columns[i].rows.push_back(row);
+        ecs.DestroyEntity(entity);
+    }
+    return transfer.cursor == transfer.candidates.size();
+}
+
+bool RegionStreamer::MergeStep(ECS& ecs, Transfer& transfer)
+{
+    auto& block = transfer.block;
+    if(!transfer.created)
+    {
+        // Every id is mapped before any component is added, components may point forward
+        if(transfer.cursor < block.entities.size())
+        {
+            transfer.remap.ids[block.entities[transfer.cursor]] = ecs.CreateEntity();
+            transfer.cursor++;
+            return false;
+        }
+        transfer.created = true;
+        transfer.cursor = 0;
+    }
+    if(transfer.cursor == block.entities.size())
+        return true;
+
+    if(transfer.cursor == 0)
+        transfer.columnCursors.assign(block.columns.size(), 0);
+
+    const uint32_t row = transfer.cursor++;
+    const EntityId entity = transfer.remap(block.entities[row]);
+    for(size_t i = 0; i < block.columns.size(); i++)
+    {
+        const auto& column = block.columns[i];
+        uint32_t& position = transfer.columnCursors[i];
+        if(position == column.rows.size() || column.rows[position] != row)
+            continue;
+
+        for(const auto& component : tracked)
+            if(component->TypeHash() == column.typeHash && component->Size() == column.componentSize)
+                component->Scatter(ecs, entity, column.data.data() + size_t(position) * column.componentSize, transfer.remap);
+        position++;
+    }
+
+    const EntityId parent = transfer.remap(block.parents[row]);
+    if(parent != INVALID_ID)
+        ecs.SetParent(entity, parent);
+    return transfer.cursor == block.entities.size();
+}
+
+void RegionStreamer::Submit(std::unique_ptr<Transfer> transfer)
+{
+    inFlight++;
+    {
+        std::lock_guard lock(mutex);
+        requests.push_back(std::move(transfer));
+    }
+    wake.notify_one();
+}
+
+bool RegionStreamer::Write(Transfer& transfer)
+{
+    const auto bytes = transfer.block.Serialize(transfer.region);
+    std::ofstream file(transfer.path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    if(!file.good())
+        return false;
+    transfer.block = {};
+    return true;
+}
+
+bool RegionStreamer::Read(Transfer& transfer)
+{
+    // Directories open fine and report a bogus size
+    std::error_code error;
+    if(!std::filesystem::is_regular_file(transfer.path, error))
+        return false;
+
+    std::ifstream file(transfer.path, std::ios::binary | std::ios::ate);
+    if(!file)
+        return false;
+    const std::streamoff size = file.tellg();
+    if(size < 0)
+        return false;
+
+    std::vector<std::byte> bytes(size);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+    return file.good() && transfer.block.Deserialize(bytes);
+}
+
+void RegionStreamer::IoWorker()
+{
+    for(;;)
+    {
+        std::unique_ptr<Transfer> transfer;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this](){ return stopping || !requests.empty(); });
+            if(requests.empty())
+                return;
+            transfer = std::move(requests.front());
+            requests.pop_front();
+            if(stopping && !transfer->write)
+                continue;
+        }
+
+        // A failure ends in the transfer's state, never on this thread
+        try
+        {
+            if(transfer->write)
+                transfer->failed = !Write(*transfer);
+            else
+                transfer->failed = !Read(*transfer);
+        }
+        catch(const std::exception&)
+        {
+            transfer->failed = true;
+        }
+
+        std::lock_guard lock(mutex);
+        finished.push_back(std::move(transfer));
+    }
+}
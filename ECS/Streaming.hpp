@@ -0,0 +1,188 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+#include "ECS.hpp"
+#include "Types.hpp"
+
+// Component, entities tagged with the same id are streamed out and in together
+struct Region
+{
+    uint32_t id = 0;
+};
+
+// Maps entity ids a region was saved with to the ids it got when loaded back,
+// ids outside the region map to INVALID_ID
+class EntityRemap
+{
+public:
+    EntityId operator()(const EntityId saved) const
+    {
+        const auto it = ids.find(saved);
+        return it == ids.end() ? INVALID_ID : it->second;
+    }
+
+private:
+    friend class RegionStreamer;
+
+    std::unordered_map<EntityId, EntityId> ids;
+};
+
+// Components of one region, laid out as in the region file
+struct RegionBlock
+{
+    struct Column
+    {
+        uint64_t typeHash = 0;
+        uint32_t componentSize = 0;
+        std::vector<uint32_t> rows;
+        std::vector<std::byte> data;
+    };
+
+    std::vector<EntityId> entities;
+    std::vector<EntityId> parents;
+    std::vector<Column> columns;
+
+    // Flat little endian file: header, entity and parent ids, then one 16 byte
+    // aligned column per component type, so a block can be read or mapped at once
+    std::vector<std::byte> Serialize(const uint32_t region) const;
+    bool Deserialize(std::span<const std::byte> bytes);
+};
+
+enum class RegionState
+{
+    Resident,
+    Unloading, // being gathered on the main thread
+    Writing,
+    Unloaded,
+    Reading,
+    Merging, // being merged on the main thread
+    Failed
+};
+
+class IStreamedComponent
+{
+public:
+    virtual uint64_t TypeHash() const = 0;
+    virtual uint32_t Size() const = 0;
+    virtual bool Gather(ECS& ecs, const EntityId entity, std::vector<std::byte>& data) const = 0;
+    virtual void Scatter(ECS& ecs, const EntityId entity, const std::byte* data, const EntityRemap& remap) const = 0;
+    virtual ~IStreamedComponent() {};
+};
+
+template <typename Component>
+class StreamedComponent : public IStreamedComponent
+{
+    static_assert(std::is_trivially_copyable_v<Component>, "Streamed components are written as raw bytes");
+
+public:
+    using RemapFunc = void(*)(Component&, const EntityRemap&);
+
+    StreamedComponent(RemapFunc remap) : remap(remap) {}
+
+    uint64_t TypeHash() const override { return std::hash<std::string>{}(typeid(Component).name()); }
+    uint32_t Size() const override { return sizeof(Component); }
+
+    bool Gather(ECS& ecs, const EntityId entity, std::vector<std::byte>& data) const override
+    {
+        const auto component = std::as_const(ecs).TryGetComponent<Component>(entity);
+        if(!component)
+            return false;
+
+        const auto* bytes = reinterpret_cast<const std::byte*>(&component->get());
+        data.insert(data.end(), bytes, bytes + sizeof(Component));
+        return true;
+    }
+
+    void Scatter(ECS& ecs, const EntityId entity, const std::byte* data, const EntityRemap& entityRemap) const override
+    {
+        Component component;
+        std::memcpy(&component, data, sizeof(Component));
+        if(remap)
+            remap(component, entityRemap);
+        ecs.AddComponent<Component>(entity, component);
+    }
+
+private:
+    RemapFunc remap;
+};
+
+// Pages regions of the world out to files and back. Files are written and read
+// on a background thread, gathering and merging entities happens in Sync() on
+// the main thread within a time budget, so a region swap is spread over frames.
+// Only tracked components are saved, the rest are dropped with the entities.
+class RegionStreamer
+{
+public:
+    RegionStreamer();
+    RegionStreamer(const RegionStreamer&) = delete;
+    RegionStreamer& operator=(const RegionStreamer&) = delete;
+    ~RegionStreamer();
+
+    // remap fixes entity ids stored inside the component after a load
+    template <typename Component>
+    void Track(typename StreamedComponent<Component>::RemapFunc remap = nullptr)
+    {
+        tracked.push_back(std::make_unique<StreamedComponent<Component>>(remap));
+    }
+
+    void Unload(ECS& ecs, const uint32_t region, const std::string& path);
+    void Load(const uint32_t region, const std::string& path, std::function<void(const EntityRemap&)> onLoaded = nullptr);
+
+    // Main thread, call once per frame at a point where structural changes are allowed.
+    // At least one entity is processed per call.
+    void Sync(ECS& ecs, const uint32_t budgetMicroseconds);
+
+    RegionState GetState(const uint32_t region) const;
+    bool Busy() const { return !unloading.empty() || !merging.empty() || inFlight > 0; }
+
+private:
+    struct Transfer
+    {
+        uint32_t region = 0;
+        std::string path;
+        RegionBlock block;
+        EntityRemap remap;
+        std::function<void(const EntityRemap&)> onLoaded;
+        std::vector<EntityId> candidates; // members at Unload(), gathered into block if still there
+        std::vector<EntityId> candidateParents;
+        std::vector<uint32_t> columnCursors;
+        uint32_t cursor = 0;
+        bool created = false;
+        bool failed = false;
+        bool write = false;
+    };
+
+    void IoWorker();
+    static bool Write(Transfer& transfer);
+    static bool Read(Transfer& transfer);
+    void Submit(std::unique_ptr<Transfer> transfer);
+    bool GatherStep(ECS& ecs, Transfer& transfer);
+    bool MergeStep(ECS& ecs, Transfer& transfer);
+
+    std::vector<std::unique_ptr<IStreamedComponent>> tracked;
+    std::unordered_map<uint32_t, RegionState> states;
+    std::deque<std::unique_ptr<Transfer>> unloading;
+    std::deque<std::unique_ptr<Transfer>> merging;
+    uint32_t inFlight = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::unique_ptr<Transfer>> requests;
+    std::deque<std::unique_ptr<Transfer>> finished;
+    bool stopping = false;
+    std::thread worker;
+};
@@ -1,61 +1,190 @@
 #pragma once
 #include "ComponentManager.hpp"
+#include "EntitySet.hpp"
+#include "Events.hpp"
+#include "FixedTimestep.hpp"
+#include "ResourceManager.hpp"
+#include "Stats.hpp"
+#include "Task.hpp"
 #include "Types.hpp"
 #include <array>
-#include <unordered_set>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Terms a system adds on top of its required components. Entities with any
+// excluded component never join, optional components are only looked up.
+struct SignatureFilter
+{
+    Signature without;
+    Signature optional;
+};
 
 class System
 {
 public:
-    void Init(Signature *signatures,
-              ComponentManager* compManager)
+    template <typename Signatures>
+    void Init(const Signatures& signatures,
+              ComponentManager* compManager,
+              ResourceManager* resManager = nullptr)
     {
         this->compManager = compManager;
+        this->resManager = resManager;
         SetSignature(systemSignature);
-        ASSERT(systemSignature.to_ulong() != 0u);
+        SetFilter(filter);
+        SetResourceAccess(resourceAccess);
+        ASSERT(systemSignature.any() && (systemSignature & filter.without).none());
         
         for(EntityId id = 0; id < MAX_ENTITY_COUNT; id++)
-            if((systemSignature.to_ulong() & signatures[id].to_ulong()) == systemSignature.to_ulong())
-                entities.emplace(id);
+            if(Matches(signatures[id]))
+                entities.Insert(id);
     }
 
     //TODO: Think about making update protected, and befriending ECS
 
     virtual void SetSignature(Signature& systemSignature) = 0;
+    virtual void SetFilter(SignatureFilter& filter){}
+    virtual void SetResourceAccess(ResourceAccess& resourceAccess){}
     virtual void Update(const float deltaTime){}
     virtual void Render(){}
+    virtual void RenderInterpolated(const float alpha){ Render(); }
 
     void OnEntityDestroyed(const EntityId entity)
     {
-        ASSERT(entities.find(entity) != entities.end())
-        entities.erase(entity);
+        ASSERT(entities.Contains(entity))
+        entities.Erase(entity);
+    }
+
+    bool Matches(const Signature& signature) const
+    {
+        return (systemSignature & signature) == systemSignature && (filter.without & signature).none();
     }
 
     void OnEntitySignatureChanged(const EntityId entity, const Signature newSignature)
     {
-        if(entities.find(entity) == entities.end())
+        if(!entities.Contains(entity))
         {     
-            if((systemSignature.to_ulong() & newSignature.to_ulong()) == systemSignature.to_ulong())
-                entities.emplace(entity);
+            if(Matches(newSignature))
+                entities.Insert(entity);
         }
         else 
-            if((systemSignature.to_ulong() & newSignature.to_ulong()) != systemSignature.to_ulong())
-                entities.erase(entity);
+            if(!Matches(newSignature))
+                entities.Erase(entity);
+    }
+
+    const ResourceAccess& GetResourceAccess() const { return resourceAccess; }
+    UpdateRate GetUpdateRate() const { return updateRate; }
+
+    virtual SystemStats GetStats() const
+    {
+        return {Demangle(typeName), entities.size(), sizeof(*this) + entities.ReservedBytes()};
     }
 
     #ifdef IN_TEST
     bool CheckIfEntitySubscribed(const EntityId entity) 
     {
-        return entities.find(entity) != entities.end();
+        return entities.Contains(entity);
     }
     #endif // IN_TEST
     
     virtual ~System(){};
 
 protected:
-    std::unordered_set<EntityId> entities;
+    template <typename Resource>
+    const Resource& ReadResource() const
+    {
+        const ResourceId id = ResourceManager::ResId<Resource>();
+        ASSERT(resourceAccess.reads.test(id) || resourceAccess.writes.test(id));
+        return std::as_const(*resManager).GetResource<Resource>();
+    }
+
+    template <typename Resource>
+    Resource& WriteResource()
+    {
+        ASSERT(resourceAccess.writes.test(ResourceManager::ResId<Resource>()));
+        return resManager->GetResource<Resource>();
+    }
+
+    // Component declared optional in SetFilter, nullptr when the entity lacks it
+    template <typename Component>
+    Component* TryGetOptional(const EntityId entity)
+    {
+        ASSERT(filter.optional.test(compManager->CompId<Component>()));
+        auto& pool = compManager->GetComponentPool<Component>();
+        return pool.Contains(entity) ? &pool.GetComponent(entity) : nullptr;
+    }
+
+    // Calls func(entity, component) for the system's entities whose Component is
+    // enabled. Walks whichever is smaller, the system's entities or the Component
+    // pool skipping disabled slots a word at a time, so the order is unspecified.
+    // Plain loops over entities visit disabled components too.
+    template <typename Component, typename Func>
+    void ForEachEnabled(Func func)
+    {
+        auto& pool = compManager->GetComponentPool<Component>();
+        if(entities.size() < pool.Size())
+        {
+            for(const EntityId entity : entities)
+                if(pool.Contains(entity) && pool.IsEnabled(entity))
+                    func(entity, pool.GetComponent(entity));
+            return;
+        }
+
+        pool.ForEach([&](const EntityId entity, Component& component)
+        {
+            if(entities.Contains(entity))
+                func(entity, component);
+        });
+    }
+
+    // Calls func(value, entities) once per distinct value of a shared component,
+    // with entities narrowed down to the members of this system
+    template <typename Component, typename Func>
+    void ForEachGroup(Func func)
+    {
+        std::vector<EntityId> members;
+        std::as_const(*compManager).GetSharedComponentPool<Component>().ForEachGroup(
+            [&](const Component& value, std::span<const EntityId> group)
+        {
+            members.clear();
+            for(const EntityId entity : group)
+                if(entities.Contains(entity))
+                    members.push_back(entity);
+            if(!members.empty())
+                func(value, std::span<const EntityId>(members));
+        });
+    }
+
+    // Runs alongside later frames, see TaskScheduler
+    void StartTask(Task task)
+    {
+        scheduler->Start(std::move(task));
+    }
+
+    // Needs Read<Events<Event>>() in SetResourceAccess
+    template <typename Event>
+    EventBatch<Event> ReadEvents(EventReader<Event>& reader) const
+    {
+        return reader.Read(ReadResource<Events<Event>>());
+    }
+
+    // Needs Write<Events<Event>>() in SetResourceAccess
+    template <typename Event>
+    void SendEvent(const Event& event)
+    {
+        WriteResource<Events<Event>>().Send(event);
+    }
+
+    EntitySet entities;
     ComponentManager* compManager;
+    ResourceManager* resManager = nullptr;
+    UpdateRate updateRate = UpdateRate::PerFrame;
 
 private: 
+    friend class ECS;
+    const char* typeName = "System";
+    TaskScheduler* scheduler = nullptr;
     Signature systemSignature;
+    SignatureFilter filter;
+    ResourceAccess resourceAccess;
 };
@@ -0,0 +1,53 @@
+#include "Task.hpp"
+#include <iterator>
+
+TaskScheduler::~TaskScheduler()
+{
+    for(const auto& task : parked)
+        task.handle.destroy();
+}
+
+void TaskScheduler::Start(Task task)
+{
+    const Task::Handle handle = std::exchange(task.handle, nullptr);
+    handle.promise().scheduler = this;
+    Park(handle);
+}
+
+void TaskScheduler::Park(const Task::Handle handle, std::function<bool()> ready)
+{
+    parked.push_back({handle, std::move(ready)});
+}
+
+void TaskScheduler::Resume()
+{
+    frameStart = Clock::now();
+    resuming.swap(parked);
+
+    std::exception_ptr exception;
+    size_t next = 0;
+    for(; next < resuming.size() && !exception && !OverBudget(); next++)
+    {
+        auto& task = resuming[next];
+        if(task.ready && !task.ready())
+        {
+            parked.push_back(std::move(task));
+            continue;
+        }
+
+        task.handle.resume();
+        if(task.handle.done())
+        {
+            exception = task.handle.promise().exception;
+            task.handle.destroy();
+        }
+    }
+
+    // Tasks the budget didn't reach go first next frame so none of them starves
+    parked.insert(parked.begin(), std::make_move_iterator(resuming.begin() + next),
+                  std::make_move_iterator(resuming.end()));
+    resuming.clear();
+
+    if(exception)
+        std::rethrow_exception(exception);
+}
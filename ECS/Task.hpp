@@ -0,0 +1,138 @@
+#pragma once
+#include <chrono>
+#include <concepts>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Types.hpp"
+
+class TaskScheduler;
+
+// Base of the awaiters below. Only they park a suspended task with the
+// scheduler, a task suspended on anything else would never be resumed.
+struct TaskAwaiter {};
+
+// Coroutine that runs over several frames. It does nothing until handed to a
+// TaskScheduler, which then owns it and resumes it once per frame at most.
+class Task
+{
+public:
+    struct promise_type
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { exception = std::current_exception(); }
+
+        // co_await on anything but a TaskAwaiter does not compile
+        template <typename Awaiter>
+            requires std::derived_from<std::remove_cvref_t<Awaiter>, TaskAwaiter>
+        Awaiter&& await_transform(Awaiter&& awaiter) { return std::forward<Awaiter>(awaiter); }
+
+        TaskScheduler* scheduler = nullptr;
+        std::exception_ptr exception;
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task& operator=(Task&&) = delete;
+    ~Task()
+    {
+        if(handle)
+            handle.destroy();
+    }
+
+private:
+    friend class TaskScheduler;
+
+    explicit Task(Handle handle) : handle(handle) {}
+
+    Handle handle;
+};
+
+// Resumes tasks once per frame, ECS::UpdateSystems() and Tick() call Resume()
+// after the systems ran. With a budget set, tasks past it wait for the next
+// frame, Yield() lets long running tasks give the time back.
+class TaskScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TaskScheduler() = default;
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+    ~TaskScheduler();
+
+    void Start(Task task);
+    void Resume();
+
+    // Zero means no limit
+    void SetBudget(const uint32_t microseconds) { budget = std::chrono::microseconds(microseconds); }
+    bool OverBudget() const { return budget.count() > 0 && Clock::now() - frameStart >= budget; }
+    size_t Pending() const { return parked.size(); }
+
+    // Called by awaiters, ready is polled every frame, an empty one means next frame
+    void Park(const Task::Handle handle, std::function<bool()> ready = nullptr);
+
+private:
+    struct Parked
+    {
+        Task::Handle handle;
+        std::function<bool()> ready;
+    };
+
+    std::vector<Parked> parked;
+    std::vector<Parked> resuming;
+    std::chrono::microseconds budget{0};
+    Clock::time_point frameStart;
+};
+
+struct NextFrameAwaiter : TaskAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(const Task::Handle handle) { handle.promise().scheduler->Park(handle); }
+    void await_resume() const noexcept {}
+};
+
+struct YieldAwaiter : TaskAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(const Task::Handle handle)
+    {
+        TaskScheduler* scheduler = handle.promise().scheduler;
+        if(!scheduler->OverBudget())
+            return false;
+        scheduler->Park(handle);
+        return true;
+    }
+    void await_resume() const noexcept {}
+};
+
+template <typename T>
+struct FutureAwaiter : TaskAwaiter
+{
+    bool await_ready() const { return Ready(); }
+    void await_suspend(const Task::Handle handle) { handle.promise().scheduler->Park(handle, [this]{ return Ready(); }); }
+    T await_resume() { return future.get(); }
+
+    bool Ready() const { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+    std::future<T> future;
+};
+
+// Suspends until the next frame's task phase
+inline NextFrameAwaiter NextFrame() { return {}; }
+
+// Suspends until the next frame only when the scheduler's budget is spent
+inline YieldAwaiter Yield() { return {}; }
+
+// Suspends until the future is ready, it is polled once per frame
+template <typename T>
+FutureAwaiter<T> WaitFor(std::future<T> future) { return {{}, std::move(future)}; }
@@ -0,0 +1,70 @@
+#pragma once
+#include <chrono>
+#include "System.hpp"
+#include "Types.hpp"
+
+// Per frame limits of a time sliced system, zero means no limit
+struct SliceBudget
+{
+    uint32_t entities = 0;
+    uint32_t microseconds = 0;
+};
+
+// Spreads a pass over its entities across frames. Each Update() resumes where the
+// previous one stopped and calls UpdateEntity() until the budget is spent, at
+// least one entity is visited per frame and a pass never wraps within a frame.
+// The cursor is the entity set's mark, so entities joining or leaving mid pass
+// don't make others get skipped or visited twice.
+class TimeSlicedSystem : public System
+{
+public:
+    virtual void UpdateEntity(const EntityId entity, const float deltaTime) = 0;
+
+    void Update(const float deltaTime) final
+    {
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        const auto deadline = start + std::chrono::microseconds(budget.microseconds);
+
+        uint32_t visited = 0;
+        while(entities.Mark() < entities.size())
+        {
+            if(visited > 0 && ((budget.entities > 0 && visited >= budget.entities) ||
+                               (budget.microseconds > 0 && Clock::now() >= deadline)))
+                break;
+
+            const EntityId entity = entities[entities.Mark()];
+            entities.SetMark(entities.Mark() + 1);
+            UpdateEntity(entity, deltaTime);
+            visited++;
+        }
+
+        passFrames++;
+        passSeconds += deltaTime;
+        if(entities.Mark() == entities.size())
+        {
+            lastPassFrames = passFrames;
+            lastPassSeconds = passSeconds;
+            passFrames = 0;
+            passSeconds = 0.0f;
+            entities.SetMark(0);
+        }
+    }
+
+    SystemStats GetStats() const override
+    {
+        SystemStats stats = System::GetStats();
+        stats.passFrames = lastPassFrames;
+        stats.passSeconds = lastPassSeconds;
+        return stats;
+    }
+
+protected:
+    SliceBudget budget;
+
+private:
+    uint32_t passFrames = 0;
+    float passSeconds = 0.0f;
+    uint32_t lastPassFrames = 0;
+    float lastPassSeconds = 0.0f;
+};
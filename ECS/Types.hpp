@@ -9,11 +9,20 @@
 #define ASSERT(statement) assert(statement); 
 #endif // DEBUG
 
-constexpr static uint32_t MAX_ENTITY_COUNT = 100000;
+#ifndef ECS_MAX_ENTITY_COUNT
+#define ECS_MAX_ENTITY_COUNT 100000
+#endif // ECS_MAX_ENTITY_COUNT
+
+constexpr static uint32_t MAX_ENTITY_COUNT = ECS_MAX_ENTITY_COUNT;
 constexpr static uint32_t MAX_COMPONENT_COUNT = 100;
 constexpr static uint32_t MAX_SYSTEM_COUNT = 100;
+constexpr static uint32_t MAX_RESOURCE_COUNT = 64;
+constexpr static uint32_t DEFAULT_PAGE_SIZE = 1024;
+constexpr static uint32_t INVALID_ID = UINT32_MAX;
 
 using EntityId = uint32_t;
 using SystemId = uint32_t;    
 using ComponentId = uint32_t;
+using ResourceId = uint32_t;
 using Signature = std::bitset<MAX_COMPONENT_COUNT>;
+using ResourceSignature = std::bitset<MAX_RESOURCE_COUNT>;
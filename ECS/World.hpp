@@ -0,0 +1,282 @@
+#pragma once
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Component.hpp"
+#include "EntityAllocator.hpp"
+#include "EntitySet.hpp"
+#include "PagedArray.hpp"
+#include "ResourceManager.hpp"
+#include "Types.hpp"
+
+template <typename... Components>
+struct ComponentList {};
+
+template <typename... Systems>
+struct SystemList {};
+
+template <typename Components, typename Systems>
+class World;
+
+// Base of the systems World runs. The required components are part of the type,
+// Update(world, deltaTime) and Render(world) are found at compile time and called
+// on the concrete system, so they can be inlined.
+template <typename... Components>
+class StaticSystem
+{
+public:
+    using Required = ComponentList<Components...>;
+
+    const EntitySet& Entities() const { return entities; }
+
+protected:
+    EntitySet entities;
+
+private:
+    template <typename, typename>
+    friend class World;
+};
+
+// Compile time counterpart of ECS for builds that know every component and system
+// up front. Component ids are indices into a tuple of pools, membership masks are
+// constants and only systems that require the changed component are visited.
+template <typename... Components, typename... Systems>
+class World<ComponentList<Components...>, SystemList<Systems...>>
+{
+    static_assert(sizeof...(Components) <= 64, "Component masks are 64 bit");
+
+    using Mask = uint64_t;
+
+public:
+    template <typename Component>
+    static constexpr ComponentId CompId()
+    {
+        constexpr ComponentId id = IndexOf<Component>();
+        static_assert(id < sizeof...(Components), "Component is not part of this World");
+        return id;
+    }
+
+    template <typename Component>
+    void RegisterComponentPool(ComponentId MAX_SIZE = MAX_ENTITY_COUNT)
+    {
+        auto& pool = GetComponentPool<Component>();
+        ASSERT(pool.Size() == 0);
+        pool = ComponentPool<Component>(MAX_SIZE);
+    }
+
+    template <typename Component>
+    ComponentPool<Component>& GetComponentPool()
+    {
+        return std::get<CompId<Component>()>(pools);
+    }
+
+    template <typename Component>
+    const ComponentPool<Component>& GetComponentPool() const
+    {
+        return std::get<CompId<Component>()>(pools);
+    }
+
+    template <typename System>
+    System& GetSystem()
+    {
+        return std::get<System>(systems);
+    }
+
+    template <typename Resource, typename... ARGS>
+    Resource& SetResource(ARGS&&... args)
+    {
+        return resManager.SetResource<Resource>(std::forward<ARGS>(args)...);
+    }
+
+    template <typename Resource>
+    Resource& GetResource()
+    {
+        return resManager.GetResource<Resource>();
+    }
+
+    template <typename Resource>
+    const Resource& GetResource() const
+    {
+        return resManager.GetResource<Resource>();
+    }
+
+    template <typename Resource>
+    bool HasResource() const
+    {
+        return resManager.HasResource<Resource>();
+    }
+
+    template <typename Resource>
+    void RemoveResource()
+    {
+        resManager.RemoveResource<Resource>();
+    }
+
+    template <typename Component>
+    Component& GetComponent(const EntityId entity)
+    {
+        ASSERT(masks[entity] & Bit<Component>());
+        return GetComponentPool<Component>().GetComponent(entity);
+    }
+
+    template <typename Component>
+    const Component& GetComponent(const EntityId entity) const
+    {
+        ASSERT(masks[entity] & Bit<Component>());
+        return GetComponentPool<Component>().GetComponent(entity);
+    }
+
+    template <typename Component>
+    std::optional<std::reference_wrapper<Component>> TryGetComponent(const EntityId entity)
+    {
+        return GetComponentPool<Component>().TryGetComponent(entity);
+    }
+
+    template <typename Component>
+    std::optional<std::reference_wrapper<const Component>> TryGetComponent(const EntityId entity) const
+    {
+        return GetComponentPool<Component>().TryGetComponent(entity);
+    }
+
+    template <typename Component, typename... ARGS>
+    Component& AddComponent(const EntityId entity, ARGS&&... args)
+    {
+        auto& comp = GetComponentPool<Component>().AddComponent(entity);
+        comp = Component(std::forward<ARGS>(args)...);
+        const Mask mask = masks.Mutable(entity) |= Bit<Component>();
+        std::apply([&](auto&... system){ (Join<Component>(system, entity, mask), ...); }, systems);
+        return comp;
+    }
+
+    template <typename Component>
+    void DeleteComponent(const EntityId entity)
+    {
+        ASSERT(masks[entity] & Bit<Component>());
+        masks.Mutable(entity) &= ~Bit<Component>();
+        std::apply([&](auto&... system){ (Leave<Component>(system, entity), ...); }, systems);
+        GetComponentPool<Component>().DeleteComponent(entity);
+    }
+
+    template <typename Component>
+    void TryDeleteComponent(const EntityId entity)
+    {
+        if(masks[entity] & Bit<Component>())
+            DeleteComponent<Component>(entity);
+    }
+
+    template <typename Component>
+    void Disable(const EntityId entity)
+    {
+        GetComponentPool<Component>().Disable(entity);
+    }
+
+    template <typename Component>
+    void Enable(const EntityId entity)
+    {
+        GetComponentPool<Component>().Enable(entity);
+    }
+
+    template <typename Component>
+    bool IsEnabled(const EntityId entity) const
+    {
+        return GetComponentPool<Component>().IsEnabled(entity);
+    }
+
+    EntityId CreateEntity()
+    {
+        return entityAllocator.Create();
+    }
+
+    void DestroyEntity(const EntityId entity)
+    {
+        const Mask mask = masks[entity];
+        masks.Mutable(entity) = 0;
+        std::apply([&](auto&... system){ (system.entities.Erase(entity), ...); }, systems);
+        std::apply([&](auto&... pool){ (DeleteIfSet(pool, entity, mask), ...); }, pools);
+        entityAllocator.Release(entity);
+    }
+
+    void UpdateSystems(const float deltaTime)
+    {
+        std::apply([&](auto&... system){ (Update(system, deltaTime), ...); }, systems);
+    }
+
+    void RenderSystems()
+    {
+        std::apply([&](auto&... system){ (Render(system), ...); }, systems);
+    }
+
+    uint32_t AliveEntities() const { return entityAllocator.Alive(); }
+
+private:
+    template <typename Component>
+    static constexpr ComponentId IndexOf()
+    {
+        ComponentId index = 0;
+        const bool found = ((std::is_same_v<Component, Components> ? true : (index++, false)) || ...);
+        return found ? index : INVALID_ID;
+    }
+
+    template <typename Component>
+    static constexpr Mask Bit()
+    {
+        return Mask(1) << CompId<Component>();
+    }
+
+    template <typename... Required>
+    static constexpr Mask MaskOf(ComponentList<Required...>)
+    {
+        return (Bit<Required>() | ... | Mask(0));
+    }
+
+    template <typename System>
+    static constexpr Mask SystemMask()
+    {
+        return MaskOf(typename System::Required{});
+    }
+
+    template <typename Component, typename System>
+    static void Join(System& system, const EntityId entity, const Mask mask)
+    {
+        constexpr Mask required = SystemMask<System>();
+        if constexpr ((required & Bit<Component>()) != 0)
+            if((mask & required) == required)
+                system.entities.Insert(entity);
+    }
+
+    template <typename Component, typename System>
+    static void Leave(System& system, const EntityId entity)
+    {
+        if constexpr ((SystemMask<System>() & Bit<Component>()) != 0)
+            system.entities.Erase(entity);
+    }
+
+    template <typename Component>
+    static void DeleteIfSet(ComponentPool<Component>& pool, const EntityId entity, const Mask mask)
+    {
+        if(mask & Bit<Component>())
+            pool.DeleteComponent(entity);
+    }
+
+    template <typename System>
+    void Update(System& system, const float deltaTime)
+    {
+        if constexpr (requires { system.Update(*this, deltaTime); })
+            system.Update(*this, deltaTime);
+    }
+
+    template <typename System>
+    void Render(System& system)
+    {
+        if constexpr (requires { system.Render(*this); })
+            system.Render(*this);
+    }
+
+    std::tuple<ComponentPool<Components>...> pools;
+    std::tuple<Systems...> systems;
+    ResourceManager resManager;
+    EntityAllocator entityAllocator;
+    PagedArray<Mask> masks{MAX_ENTITY_COUNT};
+};
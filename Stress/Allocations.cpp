@@ -0,0 +1,48 @@
+#include "Allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+namespace
+{
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+    std::atomic<uint64_t> bytes{0};
+
+    void* Allocate(std::size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        if(void* ptr = std::malloc(size ? size : 1))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void Free(void* ptr)
+    {
+        if(!ptr)
+            return;
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        std::free(ptr);
+    }
+}
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void operator delete(void* ptr) noexcept { Free(ptr); }
+void operator delete[](void* ptr) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { Free(ptr); }
+
+AllocationStats GetAllocationStats()
+{
+    return {allocations.load(), deallocations.load(), bytes.load()};
+}
+
+uint64_t GetPeakRSS()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+struct AllocationStats
+{
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Totals since program start, counted by the global operator new/delete replacements
+AllocationStats GetAllocationStats();
+
+// Peak resident set size of the process in kilobytes
+uint64_t GetPeakRSS();
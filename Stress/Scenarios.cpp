@@ -0,0 +1,474 @@
+#include "Scenarios.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include "System.hpp"
+
+namespace
+{
+
+constexpr uint32_t MAX_WORK_SYSTEMS = 30;
+
+struct Position
+{
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+struct Velocity
+{
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+struct Lifetime
+{
+    float remaining = 0.0f;
+};
+
+struct Color
+{
+    float r = 1.0f;
+    float g = 1.0f;
+    float b = 1.0f;
+    float a = 1.0f;
+};
+
+struct Stats
+{
+    int health = 100;
+    int mana = 100;
+};
+
+struct Transform
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float rotation = 0.0f;
+};
+
+struct DespawnQueue
+{
+    std::vector<EntityId> entities;
+};
+
+struct WorldTransforms
+{
+    std::vector<Transform> world;
+};
+
+class MoveSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Position>());
+        systemSignature.set(compManager->CompId<Velocity>());
+    }
+
+    void Update(const float deltaTime) override
+    {
+        for(EntityId ent : entities)
+        {
+            auto& pos = compManager->GetComponent<Position>(ent);
+            const auto& vel = compManager->GetComponent<Velocity>(ent);
+            pos.x += vel.x * deltaTime;
+            pos.y += vel.y * deltaTime;
+        }
+    }
+};
+
+class GravitySys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Velocity>());
+        systemSignature.set(compManager->CompId<Lifetime>());
+    }
+
+    void Update(const float deltaTime) override
+    {
+        for(EntityId ent : entities)
+            compManager->GetComponent<Velocity>(ent).y -= 9.81f * deltaTime;
+    }
+};
+
+class LifetimeSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Lifetime>());
+    }
+
+    void SetResourceAccess(ResourceAccess& resourceAccess) override
+    {
+        resourceAccess.Write<DespawnQueue>();
+    }
+
+    void Update(const float deltaTime) override
+    {
+        auto& queue = WriteResource<DespawnQueue>();
+        for(EntityId ent : entities)
+        {
+            auto& lifetime = compManager->GetComponent<Lifetime>(ent);
+            lifetime.remaining -= deltaTime;
+            if(lifetime.remaining <= 0.0f)
+                queue.entities.push_back(ent);
+        }
+    }
+};
+
+class FadeSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Color>());
+        systemSignature.set(compManager->CompId<Lifetime>());
+    }
+
+    void Update(const float deltaTime) override
+    {
+        for(EntityId ent : entities)
+            compManager->GetComponent<Color>(ent).a = std::min(1.0f, compManager->GetComponent<Lifetime>(ent).remaining);
+    }
+};
+
+class WanderSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Position>());
+        systemSignature.set(compManager->CompId<Velocity>());
+    }
+
+    void Update(const float deltaTime) override
+    {
+        frame++;
+        for(EntityId ent : entities)
+        {
+            if((ent + frame) % 32 != 0)
+                continue;
+            auto& vel = compManager->GetComponent<Velocity>(ent);
+            const float angle = static_cast<float>((ent * 2654435761u + frame) % 628) * 0.01f;
+            vel.x = std::cos(angle);
+            vel.y = std::sin(angle);
+        }
+    }
+
+private:
+    uint32_t frame = 0;
+};
+
+class RegenSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Stats>());
+    }
+
+    void Update(const float deltaTime) override
+    {
+        for(EntityId ent : entities)
+        {
+            auto& stats = compManager->GetComponent<Stats>(ent);
+            stats.health = std::min(stats.health + 1, 100);
+            stats.mana = std::min(stats.mana + 1, 100);
+        }
+    }
+};
+
+class TransformSys : public System
+{
+public:
+    TransformSys(const Hierarchy* hierarchy) : hierarchy(hierarchy) {}
+
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Transform>());
+    }
+
+    void SetResourceAccess(ResourceAccess& resourceAccess) override
+    {
+        resourceAccess.Write<WorldTransforms>();
+    }
+
+    void Update(const float deltaTime) override
+    {
+        const auto& nodes = hierarchy->Nodes();
+        auto& world = WriteResource<WorldTransforms>().world;
+        world.resize(nodes.size());
+        for(uint32_t i = 0; i < nodes.size(); i++)
+        {
+            const auto& local = compManager->GetComponent<Transform>(nodes[i].entity);
+            if(nodes[i].parentIndex == INVALID_ID)
+            {
+                world[i] = local;
+                continue;
+            }
+
+            const auto& parent = world[nodes[i].parentIndex];
+            const float c = std::cos(parent.rotation);
+            const float s = std::sin(parent.rotation);
+            world[i].x = parent.x + c * local.x - s * local.y;
+            world[i].y = parent.y + s * local.x + c * local.y;
+            world[i].rotation = parent.rotation + local.rotation;
+        }
+    }
+
+private:
+    const Hierarchy* hierarchy;
+};
+
+class SpinSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Transform>());
+    }
+
+    void Update(const float deltaTime) override
+    {
+        for(EntityId ent : entities)
+            compManager->GetComponent<Transform>(ent).rotation += 0.1f * deltaTime;
+    }
+};
+
+// Read-only filler systems, bring the registered system count up to what real games run
+template <size_t N>
+class WorkSys : public System
+{
+public:
+    void SetSignature(Signature& systemSignature) override
+    {
+        systemSignature.set(compManager->CompId<Position>());
+    }
+
+    void Update(const float deltaTime) override
+    {
+        float sum = 0.0f;
+        for(EntityId ent : entities)
+        {
+            const auto& pos = compManager->GetComponent<Position>(ent);
+            sum += pos.x * N + pos.y;
+        }
+        checksum = sum;
+    }
+
+private:
+    float checksum = 0.0f;
+};
+
+template <size_t... I>
+void RegisterWorkSystems(ECS& ecs, const uint32_t count, std::index_sequence<I...>)
+{
+    ((I < count ? ecs.RegisterSystem<WorkSys<I>>() : void()), ...);
+}
+
+void RegisterWorkSystems(ECS& ecs, const uint32_t registered, const uint32_t total)
+{
+    const uint32_t count = total > registered ? std::min(total - registered, MAX_WORK_SYSTEMS) : 0;
+    RegisterWorkSystems(ecs, count, std::make_index_sequence<MAX_WORK_SYSTEMS>());
+}
+
+// Spawns and despawns particles at a fixed rate, population settles at rate * average lifetime
+class ParticleStorm : public Scenario
+{
+public:
+    void Setup(ECS& ecs, const ScenarioConfig& config) override
+    {
+        this->config = config;
+        spawnRate = config.entities ? config.entities : 50000;
+        rng.seed(config.seed);
+
+        ecs.RegisterComponentPool<Position>();
+        ecs.RegisterComponentPool<Velocity>();
+        ecs.RegisterComponentPool<Lifetime>();
+        ecs.RegisterComponentPool<Color>();
+        ecs.SetResource<DespawnQueue>();
+
+        ecs.RegisterSystem<LifetimeSys>();
+        ecs.RegisterSystem<GravitySys>();
+        ecs.RegisterSystem<MoveSys>();
+        ecs.RegisterSystem<FadeSys>();
+        RegisterWorkSystems(ecs, 4, config.systems);
+    }
+
+    void Tick(ECS& ecs) override
+    {
+        spawnBudget += spawnRate * config.deltaTime;
+        std::uniform_real_distribution<float> speed(-50.0f, 50.0f);
+        std::uniform_real_distribution<float> lifetime(0.5f, 1.5f);
+        for(; spawnBudget >= 1.0f && alive < MAX_ENTITY_COUNT; spawnBudget -= 1.0f)
+        {
+            const EntityId ent = ecs.CreateEntity();
+            ecs.AddComponent<Position>(ent);
+            ecs.AddComponent<Velocity>(ent, speed(rng), speed(rng));
+            ecs.AddComponent<Lifetime>(ent, lifetime(rng));
+            ecs.AddComponent<Color>(ent);
+            alive++;
+        }
+
+        ecs.UpdateSystems(config.deltaTime);
+
+        auto& queue = ecs.GetResource<DespawnQueue>().entities;
+        for(EntityId ent : queue)
+            ecs.DestroyEntity(ent);
+        alive -= queue.size();
+        queue.clear();
+    }
+
+    uint32_t AliveEntities() const override { return alive; }
+
+private:
+    ScenarioConfig config;
+    std::mt19937 rng;
+    float spawnRate = 0.0f;
+    float spawnBudget = 0.0f;
+    uint32_t alive = 0;
+};
+
+// Large mostly idle population, a small share of movers that changes over time
+class MMOZone : public Scenario
+{
+public:
+    void Setup(ECS& ecs, const ScenarioConfig& config) override
+    {
+        this->config = config;
+        rng.seed(config.seed);
+        population = std::min(config.entities ? config.entities : 200000, MAX_ENTITY_COUNT);
+
+        ecs.RegisterComponentPool<Position>();
+        ecs.RegisterComponentPool<Velocity>();
+        ecs.RegisterComponentPool<Stats>();
+
+        std::uniform_real_distribution<float> coord(0.0f, 4096.0f);
+        for(uint32_t i = 0; i < population; i++)
+        {
+            const EntityId ent = ecs.CreateEntity();
+            ecs.AddComponent<Position>(ent, coord(rng), coord(rng));
+            ecs.AddComponent<Stats>(ent);
+            if(i % 20 == 0)
+            {
+                ecs.AddComponent<Velocity>(ent);
+                movers.push_back(ent);
+            }
+            else
+                idle.push_back(ent);
+        }
+
+        ecs.RegisterSystem<WanderSys>();
+        ecs.RegisterSystem<MoveSys>();
+        ecs.RegisterSystem<RegenSys>();
+        RegisterWorkSystems(ecs, 3, config.systems);
+    }
+
+    void Tick(ECS& ecs) override
+    {
+        const uint32_t swaps = std::max<uint32_t>(1, population / 1000);
+        for(uint32_t i = 0; i < swaps && !movers.empty() && !idle.empty(); i++)
+        {
+            const uint32_t mover = rng() % movers.size();
+            const uint32_t sleeper = rng() % idle.size();
+            ecs.DeleteComponent<Velocity>(movers[mover]);
+            ecs.AddComponent<Velocity>(idle[sleeper]);
+            std::swap(movers[mover], idle[sleeper]);
+        }
+
+        ecs.UpdateSystems(config.deltaTime);
+    }
+
+    uint32_t AliveEntities() const override { return population; }
+
+private:
+    ScenarioConfig config;
+    std::mt19937 rng;
+    uint32_t population = 0;
+    std::vector<EntityId> movers;
+    std::vector<EntityId> idle;
+};
+
+// Chains of nodes up to MAX_DEPTH deep, a few subtrees are reparented every tick
+class DeepHierarchy : public Scenario
+{
+public:
+    void Setup(ECS& ecs, const ScenarioConfig& config) override
+    {
+        this->config = config;
+        rng.seed(config.seed);
+        nodes = std::min(config.entities ? config.entities : 50000, MAX_ENTITY_COUNT);
+
+        ecs.RegisterComponentPool<Transform>();
+        ecs.RegisterComponentPool<Position>();
+        ecs.SetResource<WorldTransforms>();
+
+        std::vector<EntityId> created(nodes);
+        for(uint32_t i = 0; i < nodes; i++)
+        {
+            created[i] = ecs.CreateEntity();
+            ecs.AddComponent<Transform>(created[i], 1.0f, 0.0f, 0.01f);
+            ecs.AddComponent<Position>(created[i]);
+            if(i % MAX_DEPTH != 0)
+                ecs.SetParent(created[i], created[i - 1]);
+            else if(i > 0)
+                ecs.SetParent(created[i], created[rng() % i]);
+        }
+        entities = created;
+        ecs.SortByHierarchy<Transform>();
+
+        ecs.RegisterSystem<SpinSys>();
+        ecs.RegisterSystem<TransformSys>(&ecs.GetHierarchy());
+        RegisterWorkSystems(ecs, 2, config.systems);
+    }
+
+    void Tick(ECS& ecs) override
+    {
+        // Parents always have a lower index than their children, so this can't form a cycle
+        for(uint32_t i = 0; i < REPARENTS_PER_TICK && nodes > 1; i++)
+        {
+            const uint32_t child = 1 + rng() % (nodes - 1);
+            ecs.SetParent(entities[child], entities[rng() % child]);
+        }
+        if(++tick % RESORT_INTERVAL == 0)
+            ecs.SortByHierarchy<Transform>();
+
+        ecs.UpdateSystems(config.deltaTime);
+    }
+
+    uint32_t AliveEntities() const override { return nodes; }
+
+private:
+    static constexpr uint32_t MAX_DEPTH = 64;
+    static constexpr uint32_t REPARENTS_PER_TICK = 8;
+    static constexpr uint32_t RESORT_INTERVAL = 60;
+
+    ScenarioConfig config;
+    std::mt19937 rng;
+    uint32_t nodes = 0;
+    uint32_t tick = 0;
+    std::vector<EntityId> entities;
+};
+
+} // namespace
+
+std::unique_ptr<Scenario> MakeScenario(const std::string& name)
+{
+    if(name == "particles")
+        return std::make_unique<ParticleStorm>();
+    if(name == "mmo")
+        return std::make_unique<MMOZone>();
+    if(name == "hierarchy")
+        return std::make_unique<DeepHierarchy>();
+    return nullptr;
+}
+
+std::vector<std::string> ScenarioNames()
+{
+    return {"particles", "mmo", "hierarchy"};
+}
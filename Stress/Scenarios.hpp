@@ -0,0 +1,26 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "ECS.hpp"
+
+struct ScenarioConfig
+{
+    // Scenario specific scale: spawns per second for particles, population for mmo, nodes for hierarchy
+    uint32_t entities = 0;
+    uint32_t systems = 16;
+    uint32_t seed = 1;
+    float deltaTime = 1.0f / 60.0f;
+};
+
+class Scenario
+{
+public:
+    virtual void Setup(ECS& ecs, const ScenarioConfig& config) = 0;
+    virtual void Tick(ECS& ecs) = 0;
+    virtual uint32_t AliveEntities() const = 0;
+    virtual ~Scenario() {};
+};
+
+std::unique_ptr<Scenario> MakeScenario(const std::string& name);
+std::vector<std::string> ScenarioNames();
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "Allocations.hpp"
+#include "ECS.hpp"
+#include "Scenarios.hpp"
+
+namespace
+{
+
+struct Options
+{
+    std::string scenario = "particles";
+    uint32_t ticks = 1000;
+    uint32_t warmup = 60;
+    std::string tracePath;
+    bool printStats = false;
+    ScenarioConfig config;
+};
+
+void PrintUsage()
+{
+    std::printf("usage: ecs_stress [scenario] [--ticks N] [--warmup N] [--entities N] [--systems N] [--seed N] [--trace FILE] [--stats]\n");
+    std::printf("scenarios:");
+    for(const auto& name : ScenarioNames())
+        std::printf(" %s", name.c_str());
+    std::printf("\n");
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if(std::strcmp(argv[i], "--ticks") == 0 && hasValue)
+            options.ticks = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--warmup") == 0 && hasValue)
+            options.warmup = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--entities") == 0 && hasValue)
+            options.config.entities = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--systems") == 0 && hasValue)
+            options.config.systems = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--seed") == 0 && hasValue)
+            options.config.seed = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--trace") == 0 && hasValue)
+            options.tracePath = argv[++i];
+        else if(std::strcmp(argv[i], "--stats") == 0)
+            options.printStats = true;
+        else if(argv[i][0] != '-')
+            options.scenario = argv[i];
+        else
+            return false;
+    }
+    return options.ticks > 0;
+}
+
+double Percentile(std::vector<double> samples, const double percentile)
+{
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(percentile * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if(!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    auto scenario = MakeScenario(options.scenario);
+    if(!scenario)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    auto ecs = std::make_unique<ECS>();
+    scenario->Setup(*ecs, options.config);
+    for(uint32_t tick = 0; tick < options.warmup; tick++)
+        scenario->Tick(*ecs);
+
+    std::vector<double> tickTimes(options.ticks);
+    const AllocationStats allocsBefore = GetAllocationStats();
+    for(uint32_t tick = 0; tick < options.ticks; tick++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        scenario->Tick(*ecs);
+        const auto end = std::chrono::steady_clock::now();
+        tickTimes[tick] = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    const AllocationStats allocsAfter = GetAllocationStats();
+
+    const uint64_t allocations = allocsAfter.allocations - allocsBefore.allocations;
+    const uint64_t allocatedBytes = allocsAfter.bytes - allocsBefore.bytes;
+    const double mean = std::accumulate(tickTimes.begin(), tickTimes.end(), 0.0) / tickTimes.size();
+
+    std::printf("scenario     %s\n", options.scenario.c_str());
+    std::printf("ticks        %u (+%u warmup)\n", options.ticks, options.warmup);
+    std::printf("entities     %u alive\n", scenario->AliveEntities());
+    std::printf("tick time    mean %.3f ms  p50 %.3f ms  p99 %.3f ms  max %.3f ms\n",
+        mean, Percentile(tickTimes, 0.5), Percentile(tickTimes, 0.99),
+        *std::max_element(tickTimes.begin(), tickTimes.end()));
+    std::printf("peak RSS     %llu KB\n", static_cast<unsigned long long>(GetPeakRSS()));
+    std::printf("allocations  %llu (%.1f per tick, %llu bytes)\n",
+        static_cast<unsigned long long>(allocations), static_cast<double>(allocations) / options.ticks,
+        static_cast<unsigned long long>(allocatedBytes));
+
+    if(options.printStats)
+        std::printf("\n%s", ecs->Stats().ToString().c_str());
+
+    if(!options.tracePath.empty())
+    {
+#ifdef ECS_PROFILING
+        if(ecs->GetProfiler().SaveChromeTrace(options.tracePath))
+            std::printf("trace        %s\n", options.tracePath.c_str());
+        else
+            std::printf("trace        could not write %s\n", options.tracePath.c_str());
+#else
+        std::printf("trace        build with -DECS_PROFILING=ON to record traces\n");
+#endif // ECS_PROFILING
+    }
+
+    return 0;
+}
@@ -5,8 +5,21 @@
 #include "System.hpp"
 #include "ECS.hpp"
 #include "Types.hpp"
+#include "World.hpp"
 #include <typeindex>
 #include "ComponentManager.hpp"
+#include "Hierarchy.hpp"
+#include "Profiler.hpp"
+#include "SharedExport.hpp"
+#include "Streaming.hpp"
+#include <sstream>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <random>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
 
 class ComponentPoolTest : public testing::Test
 {
@@ -117,6 +130,45 @@ TEST_F(ComponentPoolTest, ManipulatingManyComponents)
     }
 }
 
+TEST_F(ComponentPoolTest, CloningSharesUntouchedPages)
+{
+    ComponentPool<Position> comP;
+    for(EntityId id = 0; id < 3 * DEFAULT_PAGE_SIZE; id++)
+        comP.AddComponent(id).Set(id, id);
+
+    auto clone = comP.Clone();
+    auto& cloneP = *dynamic_cast<ComponentPool<Position>*>(clone.get());
+    cloneP.GetComponent(5).Set(-1.0, -1.0);
+
+    EXPECT_DOUBLE_EQ(comP.GetComponent(5).x, 5.0) << "Writing to a clone changed the original";
+    EXPECT_DOUBLE_EQ(cloneP.GetComponent(5).x, -1.0);
+    EXPECT_DOUBLE_EQ(cloneP.GetComponent(2 * DEFAULT_PAGE_SIZE).x, 2.0 * DEFAULT_PAGE_SIZE);
+
+    cloneP.DeleteComponent(7);
+    EXPECT_TRUE(comP.TryGetComponent(7).has_value()) << "Deleting from a clone changed the original";
+    EXPECT_EQ(comP.Size(), 3 * DEFAULT_PAGE_SIZE);
+    EXPECT_EQ(cloneP.Size(), 3 * DEFAULT_PAGE_SIZE - 1);
+}
+
+TEST_F(ComponentPoolTest, SortingComponents)
+{
+    ComponentPool<Position> comP;
+    for(EntityId id = 0; id < 50; id++)
+        comP.AddComponent(id).Set((id * 37) % 50, id);
+
+    comP.Sort([](const Position& a, const Position& b){ return a.x < b.x; });
+    for(ComponentId id = 0; id < comP.Size(); id++)
+    {
+        const auto& pos = comP.GetComponent(comP.EntityAt(id));
+        EXPECT_DOUBLE_EQ(pos.x, id) << "Components are not sorted";
+        EXPECT_DOUBLE_EQ(pos.y, comP.EntityAt(id)) << "Entity index does not follow sorted components";
+    }
+
+    comP.Sort([](const Position& a, const Position& b){ return a.x > b.x; }, SortAlgorithm::Insertion);
+    for(ComponentId id = 0; id < comP.Size(); id++)
+        EXPECT_DOUBLE_EQ(comP.GetComponent(comP.EntityAt(id)).x, 49 - id) << "Components are not sorted";
+}
+
 class SystemTest : public testing::Test
 {
 protected:
@@ -474,6 +526,1015 @@ TEST_F(ECSTest, MultipleDeletionHandling)
             EXPECT_EQ(newEnts[i], 100 + i - numberOfDestroyedEnts);
 }
 
+TEST_F(ECSTest, CloningWorld)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    auto entities = CreateEntitiesArray(ecs, 10);
+    ecs.AddComponents<Position>(std::span(entities.begin(), entities.end()));
+    ecs.AddComponent<Rotation>(entities[0]);
+    ecs.RegisterSystem<DummySys1>();
+    ecs.RegisterSystem<DummySys2>();
+
+    auto fork = ecs.Clone();
+    EntityId forkEnt = fork->CreateEntity();
+    fork->UpdateSystems(0.1);
+    fork->DestroyEntity(entities[1]);
+
+    EXPECT_DOUBLE_EQ(fork->GetComponent<Position>(entities[0]).x, 3.0);
+    EXPECT_DOUBLE_EQ(fork->GetComponent<Position>(entities[2]).x, 1.0);
+    EXPECT_DOUBLE_EQ(fork->GetComponent<Rotation>(entities[0]).deg, 2.0);
+    EXPECT_ANY_THROW(fork->GetComponent<Position>(entities[1]));
+
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(entities[0]).x, 0.0) << "Updating a fork changed the original";
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(entities[0]).deg, 0.0);
+    EXPECT_NO_THROW(ecs.GetComponent<Position>(entities[1])) << "Destroying in a fork changed the original";
+    EXPECT_EQ(ecs.CreateEntity(), forkEnt);
+
+    fork.reset();
+    ecs.UpdateSystems(0.1);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(entities[0]).x, 3.0);
+}
+
+TEST_F(ECSTest, SortingPoolsAsOtherPool)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    auto entities = CreateEntitiesArray(ecs, 20);
+    for(EntityId ent : entities)
+    {
+        ecs.AddComponent<Position>(ent, ent, 0);
+        if(ent % 2 == 0)
+            ecs.AddComponent<Rotation>(ent, 100.0 - ent);
+    }
+
+    ecs.Sort<Rotation>([](const Rotation& a, const Rotation& b){ return a.deg < b.deg; });
+    ecs.SortAs<Position, Rotation>();
+
+    std::vector<EntityId> order;
+    ecs.GetComponentPool<Position>().ForEach([&](EntityId ent, Position& pos){ order.push_back(ent); });
+    ASSERT_EQ(order.size(), 20u);
+    for(EntityId i = 0; i < 10; i++)
+        EXPECT_EQ(order[i], 18 - 2 * i) << "Position pool does not follow Rotation pool order";
+    for(EntityId i = 10; i < 20; i++)
+        EXPECT_EQ(order[i] % 2, 1u);
+    for(EntityId ent : entities)
+        EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(ent).x, ent);
+}
+
+TEST_F(ECSTest, MemoryStats)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>(100);
+    auto entities = CreateEntitiesArray(ecs, 30);
+    ecs.AddComponents<Position>(std::span(entities.begin(), entities.end()));
+    ecs.AddComponent<Rotation>(entities[0]);
+    ecs.RegisterSystem<DummySys1>();
+    ecs.RegisterSystem<DummySys2>();
+
+    ECSStats stats = ecs.Stats();
+    EXPECT_EQ(stats.aliveEntities, 30u);
+    ASSERT_EQ(stats.pools.size(), 2u);
+    EXPECT_EQ(stats.pools[0].live, 30u);
+    EXPECT_EQ(stats.pools[1].live, 1u);
+    EXPECT_EQ(stats.pools[1].capacity, 100u);
+    EXPECT_EQ(stats.pools[1].componentSize, sizeof(Rotation));
+    EXPECT_NE(stats.pools[0].name.find("Position"), std::string::npos);
+    for(const auto& pool : stats.pools)
+    {
+        EXPECT_GE(pool.bytesReserved, pool.bytesUsed);
+        EXPECT_GE(pool.Fragmentation(), 0.0);
+        EXPECT_LT(pool.Fragmentation(), 1.0);
+    }
+
+    ASSERT_EQ(stats.systems.size(), 2u);
+    EXPECT_EQ(stats.systems[0].entities, 30u);
+    EXPECT_EQ(stats.systems[1].entities, 1u);
+    EXPECT_NE(stats.systems[1].name.find("DummySys2"), std::string::npos);
+    EXPECT_GT(stats.TotalBytes(), stats.pools[0].bytesReserved);
+    EXPECT_NE(stats.ToString().find("DummySys1"), std::string::npos);
+
+    ecs.DeleteComponents<Position>(std::span(entities.begin() + 10, entities.end()));
+    EXPECT_EQ(ecs.Stats().pools[0].live, 10u);
+    EXPECT_GT(ecs.Stats().pools[0].Fragmentation(), stats.pools[0].Fragmentation());
+}
+
+TEST_F(ECSTest, WorldResources)
+{
+    struct Time
+    {
+        float deltaTime = 0.0f;
+        float elapsed = 0.0f;
+    };
+
+    class ClockSys : public System
+    {
+    public:
+        void SetSignature(Signature& systemSignature) override
+        {
+            systemSignature.set(compManager->CompId<Position>());
+        }
+
+        void SetResourceAccess(ResourceAccess& resourceAccess) override
+        {
+            resourceAccess.Write<Time>();
+        }
+
+        void Update(float deltaTime) override
+        {
+            auto& time = WriteResource<Time>();
+            time.deltaTime = deltaTime;
+            time.elapsed += deltaTime;
+        }
+    };
+
+    class SneakySys : public DummySys1
+    {
+    public:
+        void Update(float deltaTime) override
+        {
+            ReadResource<Time>();
+        }
+    };
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    EXPECT_FALSE(ecs.HasResource<Time>());
+    EXPECT_ANY_THROW(ecs.GetResource<Time>()) << "Getting access to non-existent resource";
+
+    ecs.SetResource<Time>(0.0f, 1.0f);
+    ecs.RegisterSystem<ClockSys>();
+    ecs.UpdateSystems(0.5f);
+    EXPECT_FLOAT_EQ(ecs.GetResource<Time>().deltaTime, 0.5f);
+    EXPECT_FLOAT_EQ(ecs.GetResource<Time>().elapsed, 1.5f);
+
+    auto fork = ecs.Clone();
+    fork->UpdateSystems(0.5f);
+    EXPECT_FLOAT_EQ(fork->GetResource<Time>().elapsed, 2.0f);
+    EXPECT_FLOAT_EQ(ecs.GetResource<Time>().elapsed, 1.5f) << "Updating a fork changed the original resource";
+
+    ecs.RegisterSystem<SneakySys>();
+    EXPECT_ANY_THROW(ecs.UpdateSystems(0.5f)) << "System read a resource it did not declare";
+
+    ecs.RemoveResource<Time>();
+    EXPECT_FALSE(ecs.HasResource<Time>());
+}
+
+TEST_F(ECSTest, FixedTimestepLoop)
+{
+    class FixedSys : public DummySys1
+    {
+    public:
+        FixedSys() { updateRate = UpdateRate::Fixed; }
+
+        void Update(float deltaTime) override
+        {
+            EXPECT_FLOAT_EQ(deltaTime, 0.1f);
+            DummySys1::Update(deltaTime);
+        }
+    };
+
+    class AlphaSys : public DummySys2
+    {
+    public:
+        AlphaSys(float* lastAlpha) : lastAlpha(lastAlpha) {}
+        void RenderInterpolated(float alpha) override { *lastAlpha = alpha; }
+        float* lastAlpha;
+    };
+
+    float lastAlpha = -1.0f;
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    auto ent = ecs.CreateEntity();
+    ecs.AddComponent<Position>(ent);
+    ecs.AddComponent<Rotation>(ent);
+    ecs.RegisterSystem<FixedSys>();
+    ecs.RegisterSystem<AlphaSys>(&lastAlpha);
+    ecs.SetFixedTimestep(0.1f, 4);
+
+    ecs.Tick(0.25f);
+    EXPECT_EQ(ecs.GetFixedTimestep().Stats().lastFrameSteps, 2u);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(ent).x, 2.0 + 2.0) << "2 fixed steps and 1 frame update";
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(ent).deg, 2.0);
+
+    ecs.RenderSystems();
+    EXPECT_NEAR(lastAlpha, 0.5f, 1e-4) << "Render systems did not get the interpolation alpha";
+
+    ecs.Tick(10.0f);
+    const auto& stats = ecs.GetFixedTimestep().Stats();
+    EXPECT_EQ(stats.lastFrameSteps, 4u) << "Spiral of death guard did not clamp steps";
+    EXPECT_EQ(stats.clampedFrames, 1u);
+    EXPECT_GT(stats.droppedTime, 9.0);
+    EXPECT_EQ(stats.totalSteps, 6u);
+    EXPECT_DOUBLE_EQ(stats.AverageStepsPerFrame(), 3.0);
+    EXPECT_LT(ecs.GetFixedTimestep().Alpha(), 1.0f);
+}
+
+TEST_F(ECSTest, EventBus)
+{
+    struct Hit
+    {
+        EntityId target;
+        double damage;
+    };
+
+    class DamageSys : public DummySys2
+    {
+    public:
+        void SetResourceAccess(ResourceAccess& resourceAccess) override
+        {
+            resourceAccess.Read<Events<Hit>>();
+        }
+
+        void Update(float deltaTime) override
+        {
+            auto hits = ReadEvents(reader);
+            hits.ForEach([&](const Hit& hit)
+            {
+                compManager->GetComponent<Rotation>(hit.target).deg -= hit.damage;
+            });
+        }
+
+        EventReader<Hit> reader;
+    };
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    auto entities = CreateEntitiesArray(ecs, 3);
+    for(EntityId ent : entities)
+    {
+        ecs.AddComponent<Position>(ent);
+        ecs.AddComponent<Rotation>(ent, 100.0);
+    }
+    auto& hits = ecs.RegisterEvent<Hit>();
+    ecs.RegisterSystem<DamageSys>();
+
+    ecs.SendEvent(Hit{entities[0], 10.0});
+    ecs.SendEvent(Hit{entities[1], 5.0});
+    ecs.SendEvent(Hit{entities[0], 1.0});
+    ecs.UpdateSystems(0.0f);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(entities[0]).deg, 89.0);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(entities[1]).deg, 95.0);
+
+    EventReader<Hit> lateReader;
+    EXPECT_EQ(lateReader.Read(hits).older.size(), 3u) << "Events sent last frame should still be readable";
+    hits.Send({entities[2], 1.0});
+    auto batch = lateReader.Read(hits);
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_EQ(batch.newer[0].target, entities[2]);
+    EXPECT_TRUE(lateReader.Read(hits).empty());
+
+    ecs.UpdateSystems(0.0f);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(entities[0]).deg, 89.0) << "Event was read twice";
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(entities[2]).deg, 99.0);
+
+    EventReader<Hit> slowReader;
+    slowReader.Read(hits);
+    hits.Send({entities[2], 1.0});
+    ecs.UpdateEvents();
+    ecs.UpdateEvents();
+    EXPECT_TRUE(slowReader.Read(hits).empty());
+    EXPECT_EQ(slowReader.Lost(), 1u) << "Reader was not told about dropped events";
+    EXPECT_EQ(hits.Size(), 0u);
+    EXPECT_EQ(hits.Sent(), 5u);
+}
+
+TEST_F(ECSTest, Prefabs)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>(2000);
+    ecs.RegisterSystem<DummySys1>();
+    ecs.RegisterSystem<DummySys2>();
+
+    Position start;
+    start.Set(1.0, 2.0);
+    auto ship = ecs.CreatePrefab(start, Rotation{45.0});
+    auto wave = ecs.Instantiate(ship, 1500);
+    ASSERT_EQ(wave.size(), 1500u);
+
+    auto marker = ecs.CreatePrefab(start);
+    marker.Get<Position>().x = 7.0;
+    EXPECT_FALSE(marker.TryGet<Rotation>().has_value());
+    EXPECT_ANY_THROW(marker.Get<Rotation>());
+    EXPECT_ANY_THROW(Prefab().Get<Position>()) << "Empty prefab";
+    auto markers = ecs.Instantiate(marker, 10);
+
+    ECSStats stats = ecs.Stats();
+    EXPECT_EQ(stats.systems[0].entities, 1510u);
+    EXPECT_EQ(stats.systems[1].entities, 1500u) << "Position only prefab joined a Position+Rotation system";
+    EXPECT_EQ(stats.pools[0].live, 1510u);
+    for(EntityId ent : wave)
+    {
+        EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(ent).y, 2.0);
+        EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(ent).deg, 45.0);
+    }
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(markers[9]).x, 7.0);
+    EXPECT_FALSE(ecs.TryGetComponent<Rotation>(markers[0]));
+
+    ecs.UpdateSystems(0.0f);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(wave[0]).x, 4.0);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(wave[1499]).deg, 47.0);
+
+    EXPECT_ANY_THROW(ecs.Instantiate(ship, 600)) << "Rotation pool only has room for 500 more";
+    EXPECT_EQ(ecs.Stats().pools[0].live, 1510u) << "Failed instantiation left partial state";
+
+    ecs.DestroyEntities(std::span(wave.begin(), wave.begin() + 1000));
+    stats = ecs.Stats();
+    EXPECT_EQ(stats.systems[1].entities, 500u);
+    EXPECT_EQ(stats.pools[1].live, 500u);
+    EXPECT_NO_THROW(ecs.Instantiate(ship, 1500));
+}
+
+TEST_F(ECSTest, SignatureFilters)
+{
+    struct Hidden {};
+
+    class VisibleSys : public DummySys1
+    {
+    public:
+        void SetFilter(SignatureFilter& filter) override
+        {
+            filter.without.set(compManager->CompId<Hidden>());
+            filter.optional.set(compManager->CompId<Rotation>());
+        }
+
+        void Update(float deltaTime) override
+        {
+            turned = 0;
+            for(EntityId ent : entities)
+                if(Rotation* rot = TryGetOptional<Rotation>(ent))
+                    turned += rot->deg;
+        }
+
+        double turned = 0.0;
+    };
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    ecs.RegisterComponentPool<Hidden>();
+    auto entities = CreateEntitiesArray(ecs, 4);
+    for(EntityId ent : entities)
+        ecs.AddComponent<Position>(ent);
+    ecs.AddComponent<Rotation>(entities[0], 10.0);
+    ecs.AddComponent<Rotation>(entities[1], 20.0);
+    ecs.AddComponent<Hidden>(entities[1]);
+    ecs.RegisterSystem<VisibleSys>();
+    ecs.RegisterSystem<DummySys2>();
+
+    auto stats = ecs.Stats();
+    EXPECT_EQ(stats.systems[0].entities, 3u) << "Excluded entity joined at registration";
+    EXPECT_EQ(stats.systems[1].entities, 2u);
+
+    ecs.AddComponent<Hidden>(entities[2]);
+    ecs.DeleteComponent<Hidden>(entities[1]);
+    EXPECT_EQ(ecs.Stats().systems[0].entities, 3u);
+    ecs.UpdateSystems(0.0f);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(entities[1]).deg, 22.0);
+
+    auto hidden = ecs.CreatePrefab(Position{}, Hidden{});
+    ecs.Instantiate(hidden, 5);
+    EXPECT_EQ(ecs.Stats().systems[0].entities, 3u) << "Prefab ignored the exclusion";
+}
+
+template <int N>
+struct Tag {};
+
+TEST_F(ECSTest, WideSignatures)
+{
+    ECS ecs;
+    [&]<int... N>(std::integer_sequence<int, N...>)
+    {
+        (ecs.RegisterComponentPool<Tag<N>>(4), ...);
+    }(std::make_integer_sequence<int, 70>{});
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    ecs.RegisterSystem<DummySys2>();
+
+    auto entities = CreateEntitiesArray(ecs, 2);
+    ecs.AddComponent<Tag<69>>(entities[0]);
+    ecs.AddComponent<Position>(entities[0]);
+    ecs.AddComponent<Rotation>(entities[0]);
+    ecs.AddComponent<Position>(entities[1]);
+    EXPECT_EQ(ecs.Stats().systems[0].entities, 1u) << "Component ids past 64 broke membership";
+}
+
+TEST_F(ECSTest, ConcurrentSpawning)
+{
+    constexpr uint32_t WORKERS = 4;
+    constexpr uint32_t SPAWNS = 2000;
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    ecs.RegisterSystem<DummySys2>();
+    ecs.SetStageCount(WORKERS);
+    auto doomed = CreateEntitiesArray(ecs, SPAWNS);
+
+    std::array<std::vector<EntityId>, WORKERS> spawned;
+    std::vector<std::thread> workers;
+    for(uint32_t worker = 0; worker < WORKERS; worker++)
+        workers.emplace_back([&, worker]()
+        {
+            ComponentStage& stage = ecs.GetStage(worker);
+            for(uint32_t i = 0; i < SPAWNS; i++)
+            {
+                const EntityId ent = stage.CreateEntity();
+                stage.AddComponent<Position>(ent);
+                stage.AddComponent<Rotation>(ent, double(worker));
+                spawned[worker].push_back(ent);
+            }
+        });
+    for(EntityId ent : doomed)
+        ecs.DestroyEntity(ent);
+    for(auto& thread : workers)
+        thread.join();
+
+    EXPECT_EQ(ecs.Stats().systems[0].entities, 0u) << "Staged components applied before the sync point";
+    ecs.UpdateSystems(0.0f);
+
+    std::vector<EntityId> all;
+    for(uint32_t worker = 0; worker < WORKERS; worker++)
+    {
+        all.insert(all.end(), spawned[worker].begin(), spawned[worker].end());
+        for(EntityId ent : spawned[worker])
+            EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(ent).deg, worker) << "Component staged for another entity";
+    }
+    std::sort(all.begin(), all.end());
+    EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end()) << "Entity id handed out twice";
+
+    auto stats = ecs.Stats();
+    EXPECT_EQ(stats.aliveEntities, WORKERS * SPAWNS);
+    EXPECT_EQ(stats.systems[0].entities, WORKERS * SPAWNS);
+    EXPECT_EQ(stats.pools[1].live, WORKERS * SPAWNS);
+}
+
+TEST_F(ECSTest, TimeSlicedSystems)
+{
+    class PlannerSys : public TimeSlicedSystem
+    {
+    public:
+        PlannerSys() { budget.entities = 10; }
+
+        void SetSignature(Signature& systemSignature) override
+        {
+            systemSignature.set(compManager->CompId<Position>());
+        }
+
+        void UpdateEntity(const EntityId entity, const float deltaTime) override
+        {
+            compManager->GetComponent<Position>(entity).x += 1.0;
+        }
+    };
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterSystem<PlannerSys>();
+    auto entities = CreateEntitiesArray(ecs, 35);
+    for(EntityId ent : entities)
+        ecs.AddComponent<Position>(ent);
+
+    auto visits = [&](const EntityId ent){ return ecs.GetComponent<Position>(ent).x; };
+    for(int frame = 0; frame < 4; frame++)
+        ecs.UpdateSystems(0.25f);
+    for(EntityId ent : entities)
+        EXPECT_DOUBLE_EQ(visits(ent), 1.0);
+    EXPECT_EQ(ecs.Stats().systems[0].passFrames, 4u);
+    EXPECT_FLOAT_EQ(ecs.Stats().systems[0].passSeconds, 1.0f);
+
+    ecs.UpdateSystems(0.25f);
+    ecs.UpdateSystems(0.25f);
+    ecs.DestroyEntity(entities[0]);
+    ecs.DestroyEntity(entities[30]);
+    ecs.DeleteComponent<Position>(entities[3]);
+    const EntityId late = ecs.CreateEntity();
+    ecs.AddComponent<Position>(late);
+    ecs.UpdateSystems(0.25f);
+    ecs.UpdateSystems(0.25f);
+
+    for(EntityId ent : entities)
+        if(ent != entities[0] && ent != entities[30] && ent != entities[3])
+        {
+            EXPECT_DOUBLE_EQ(visits(ent), 2.0) << "Entity " << ent << " skipped or visited twice after the set changed";
+        }
+    EXPECT_DOUBLE_EQ(visits(late), 1.0);
+    EXPECT_EQ(ecs.Stats().systems[0].passFrames, 4u);
+}
+
+template <typename Awaitable>
+concept TaskCanAwait = requires(Task::promise_type& promise, Awaitable awaitable) { promise.await_transform(std::move(awaitable)); };
+
+TEST_F(ECSTest, CoroutineTasks)
+{
+    static_assert(TaskCanAwait<NextFrameAwaiter> && TaskCanAwait<FutureAwaiter<int>>);
+    static_assert(!TaskCanAwait<std::suspend_always>, "Tasks could suspend on an awaiter that never parks them");
+
+    class PathSys : public DummySys1
+    {
+    public:
+        PathSys(std::promise<double>* route) : route(route) {}
+
+        void Update(float deltaTime) override
+        {
+            if(!started)
+                StartTask(Walk(*entities.begin()));
+            started = true;
+        }
+
+        Task Walk(const EntityId ent)
+        {
+            compManager->GetComponent<Position>(ent).x = 1.0;
+            co_await NextFrame();
+            compManager->GetComponent<Position>(ent).x = 2.0;
+            compManager->GetComponent<Position>(ent).x = co_await WaitFor(route->get_future());
+        }
+
+        std::promise<double>* route;
+        bool started = false;
+    };
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    auto entities = CreateEntitiesArray(ecs, 1);
+    ecs.AddComponent<Position>(entities[0]);
+    std::promise<double> route;
+    ecs.RegisterSystem<PathSys>(&route);
+    auto x = [&](){ return ecs.GetComponent<Position>(entities[0]).x; };
+
+    ecs.UpdateSystems(0.0f);
+    EXPECT_DOUBLE_EQ(x(), 1.0);
+    ecs.UpdateSystems(0.0f);
+    ecs.UpdateSystems(0.0f);
+    EXPECT_DOUBLE_EQ(x(), 2.0) << "Task did not wait for the future";
+    EXPECT_EQ(ecs.GetTasks().Pending(), 1u);
+
+    auto clone = ecs.Clone();
+    EXPECT_EQ(clone->GetTasks().Pending(), 0u);
+
+    route.set_value(5.0);
+    ecs.UpdateSystems(0.0f);
+    EXPECT_DOUBLE_EQ(x(), 5.0);
+    EXPECT_EQ(ecs.GetTasks().Pending(), 0u);
+
+    auto spinner = [](uint32_t& steps) -> Task
+    {
+        for(int i = 0; i < 2; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            while(std::chrono::steady_clock::now() - start < std::chrono::microseconds(200)) {}
+            steps++;
+            co_await Yield();
+        }
+    };
+    uint32_t first = 0, second = 0;
+    ecs.GetTasks().SetBudget(50);
+    ecs.StartTask(spinner(first));
+    ecs.StartTask(spinner(second));
+    for(int frame = 0; frame < 4; frame++)
+        ecs.UpdateSystems(0.0f);
+    EXPECT_EQ(first, 2u) << "Budget was not respected";
+    EXPECT_EQ(second, 2u) << "Task starved behind an over budget one";
+
+    ecs.UpdateSystems(0.0f);
+    EXPECT_EQ(ecs.GetTasks().Pending(), 0u);
+
+    ecs.GetTasks().SetBudget(0);
+    ecs.StartTask([]() -> Task
+    {
+        co_await NextFrame();
+        throw 7;
+    }());
+    EXPECT_NO_THROW(ecs.UpdateSystems(0.0f));
+    EXPECT_ANY_THROW(ecs.UpdateSystems(0.0f));
+}
+
+TEST_F(ECSTest, DisabledComponents)
+{
+    class SleepSys : public DummySys1
+    {
+    public:
+        void Update(float deltaTime) override
+        {
+            ForEachEnabled<Position>([](EntityId, Position& pos){ pos.x += 1.0; });
+        }
+    };
+
+    // Fewer members than the pool has components, walks its own entities
+    class SmallSleepSys : public DummySys2
+    {
+    public:
+        void Update(float deltaTime) override
+        {
+            ForEachEnabled<Position>([&](EntityId ent, Position&){ compManager->GetComponent<Rotation>(ent).deg += 1.0; });
+        }
+    };
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    ecs.RegisterSystem<SleepSys>();
+    ecs.RegisterSystem<SmallSleepSys>();
+    auto entities = CreateEntitiesArray(ecs, 200);
+    for(EntityId ent : entities)
+        ecs.AddComponent<Position>(ent).y = ent;
+    ecs.AddComponent<Rotation>(entities[0]);
+    ecs.AddComponent<Rotation>(entities[1]);
+
+    auto asleep = [&](const EntityId ent){ return ent % 3 == 0; };
+    for(EntityId ent : entities)
+        if(asleep(ent))
+            ecs.Disable<Position>(ent);
+    ecs.Disable<Position>(entities[0]);
+    EXPECT_EQ(ecs.GetComponentPool<Position>().DisabledCount(), 67u);
+    EXPECT_EQ(ecs.Stats().systems[0].entities, 200u) << "Disabling changed system membership";
+
+    ecs.UpdateSystems(0.0f);
+    ecs.DestroyEntity(entities[3]);
+    ecs.DestroyEntity(entities[100]);
+    ecs.DeleteComponent<Position>(entities[199]);
+    ecs.Sort<Position>([](const Position& a, const Position& b){ return a.y > b.y; });
+    ecs.UpdateSystems(0.0f);
+
+    for(EntityId ent : entities)
+    {
+        if(ent == entities[3] || ent == entities[100] || ent == entities[199])
+            continue;
+        EXPECT_EQ(ecs.IsEnabled<Position>(ent), !asleep(ent));
+        EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(ent).x, asleep(ent) ? 0.0 : 2.0) << "Entity " << ent;
+        EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(ent).y, ent) << "Disabled component lost its data";
+    }
+    EXPECT_EQ(ecs.GetComponentPool<Position>().DisabledCount(), 66u);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(entities[0]).deg, 0.0);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(entities[1]).deg, 2.0);
+
+    for(EntityId ent : entities)
+        if(ecs.TryGetComponent<Position>(ent))
+            ecs.Enable<Position>(ent);
+    ecs.UpdateSystems(0.0f);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(entities[0]).x, 1.0);
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(entities[1]).x, 3.0);
+    EXPECT_EQ(ecs.GetComponentPool<Position>().DisabledCount(), 0u);
+}
+
+TEST_F(ECSTest, SharedComponents)
+{
+    struct Material
+    {
+        int shader = 0;
+        std::array<double, 32> params{};
+
+        bool operator==(const Material&) const = default;
+    };
+
+    using Batches = std::vector<std::pair<int, uint32_t>>;
+
+    class MaterialSys : public DummySys1
+    {
+    public:
+        MaterialSys(Batches* batches) : batches(batches) {}
+
+        void SetSignature(Signature& systemSignature) override
+        {
+            DummySys1::SetSignature(systemSignature);
+            systemSignature.set(compManager->CompId<Material>());
+        }
+
+        void Update(float deltaTime) override
+        {
+            batches->clear();
+            ForEachGroup<Material>([&](const Material& material, std::span<const EntityId> members)
+            {
+                batches->push_back({material.shader, uint32_t(members.size())});
+                for(EntityId ent : members)
+                    compManager->GetComponent<Position>(ent).x = material.params[0];
+            });
+            std::sort(batches->begin(), batches->end());
+        }
+
+        Batches* batches;
+    };
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterSharedComponentPool<Material>();
+    auto entities = CreateEntitiesArray(ecs, 100);
+    std::array<Material, 3> materials;
+    for(int i = 0; i < 3; i++)
+    {
+        materials[i].shader = i;
+        materials[i].params[0] = 10.0 * i;
+    }
+    for(EntityId ent : entities)
+    {
+        if(ent != entities[99])
+            ecs.AddComponent<Position>(ent);
+        ecs.AddSharedComponent(ent, materials[ent % 3]);
+    }
+    Batches batches;
+    ecs.RegisterSystem<MaterialSys>(&batches);
+
+    auto& pool = ecs.GetSharedComponentPool<Material>();
+    EXPECT_EQ(pool.ValueCount(), 3u);
+    EXPECT_EQ(&ecs.GetSharedComponent<Material>(entities[0]), &ecs.GetSharedComponent<Material>(entities[3]))
+        << "Equal values were not deduplicated";
+    EXPECT_LT(pool.GetStats().bytesUsed, 100 * sizeof(Material) / 4);
+
+    ecs.UpdateSystems(0.0f);
+    EXPECT_EQ(batches, (Batches{{0, 33}, {1, 33}, {2, 33}})) << "Entity outside the system was grouped";
+    EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(entities[2]).x, 20.0);
+
+    auto clone = ecs.Clone();
+    Material custom = materials[0];
+    custom.shader = 7;
+    ecs.SetSharedComponent(entities[1], custom);
+    ecs.SetSharedComponent(entities[4], materials[0]);
+    ecs.DeleteSharedComponent<Material>(entities[7]);
+    ecs.DestroyEntity(entities[10]);
+    EXPECT_EQ(pool.ValueCount(), 4u);
+    EXPECT_EQ(ecs.GetSharedComponent<Material>(entities[4]).shader, 0);
+
+    ecs.UpdateSystems(0.0f);
+    EXPECT_EQ(batches, (Batches{{0, 34}, {1, 29}, {2, 33}, {7, 1}}));
+
+    ecs.SetSharedComponent(entities[1], materials[1]);
+    EXPECT_EQ(pool.ValueCount(), 3u) << "Unused value was not released";
+    ecs.SetSharedComponent(entities[1], materials[1]);
+    EXPECT_EQ(pool.Size(), 98u);
+
+    clone->UpdateSystems(0.0f);
+    EXPECT_EQ(batches, (Batches{{0, 33}, {1, 33}, {2, 33}})) << "Clone shares groups with the original";
+
+    const Material& held = ecs.GetSharedComponent<Material>(entities[0]);
+    for(int i = 0; i < 64; i++)
+    {
+        custom.shader = 100 + i;
+        ecs.SetSharedComponent(entities[20 + i], custom);
+    }
+    EXPECT_EQ(pool.ValueCount(), 67u);
+    EXPECT_EQ(&held, &ecs.GetSharedComponent<Material>(entities[0])) << "Adding values moved existing ones";
+    EXPECT_EQ(held.shader, 0);
+
+    EXPECT_ANY_THROW(ecs.AddComponent<Material>(entities[99])) << "Shared type used through the plain pool";
+    EXPECT_ANY_THROW(ecs.Disable<Material>(entities[0]));
+    EXPECT_ANY_THROW(ecs.GetSharedComponentPool<Position>()) << "Plain type used through the shared pool";
+}
+
+TEST_F(ECSTest, RegionStreaming)
+{
+    struct Target
+    {
+        EntityId entity = INVALID_ID;
+    };
+
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    ecs.RegisterComponentPool<Target>();
+    ecs.RegisterComponentPool<Region>();
+    ecs.RegisterSystem<DummySys1>();
+    ecs.RegisterSystem<DummySys2>();
+
+    auto entities = CreateEntitiesArray(ecs, 50);
+    for(EntityId i = 0; i < 50; i++)
+    {
+        ecs.AddComponent<Position>(entities[i], double(i), 0.0);
+        ecs.AddComponent<Region>(entities[i], i < 30 ? 1u : 2u);
+        if(i < 30 && i % 3 == 0)
+            ecs.AddComponent<Rotation>(entities[i], 10.0 * i);
+        if(i > 0 && i < 30)
+        {
+            ecs.SetParent(entities[i], entities[0]);
+            ecs.AddComponent<Target>(entities[i], entities[i - 1]);
+        }
+    }
+    ecs.AddComponent<Target>(entities[0], entities[40]);
+
+    RegionStreamer streamer;
+    streamer.Track<Position>();
+    streamer.Track<Rotation>();
+    streamer.Track<Target>([](Target& target, const EntityRemap& remap){ target.entity = remap(target.entity); });
+
+    const auto path = (std::filesystem::temp_directory_path() / "ecs_region_1.bin").string();
+    auto syncUntil = [&](RegionState state, uint32_t budget)
+    {
+        int syncs = 0;
+        for(; streamer.GetState(1) != state && syncs < 10000; syncs++)
+        {
+            streamer.Sync(ecs, budget);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return syncs;
+    };
+
+    streamer.Unload(ecs, 1, path);
+    EXPECT_EQ(streamer.GetState(1), RegionState::Unloading);
+    EXPECT_EQ(ecs.Stats().aliveEntities, 50u) << "Unload() must not touch the world outside Sync()";
+    // Members that leave before they are gathered stay out of the file
+    ecs.DestroyEntity(entities[29]);
+    ecs.GetComponent<Region>(entities[28]).id = 2;
+    streamer.Sync(ecs, 0);
+    EXPECT_EQ(ecs.Stats().aliveEntities, 48u) << "A zero budget still has to make progress";
+    syncUntil(RegionState::Unloaded, 1000);
+    ASSERT_EQ(streamer.GetState(1), RegionState::Unloaded);
+    EXPECT_FALSE(streamer.Busy());
+    EXPECT_EQ(ecs.Stats().aliveEntities, 21u);
+    EXPECT_EQ(ecs.Stats().systems[0].entities, 21u);
+    EXPECT_EQ(ecs.Stats().systems[1].entities, 0u);
+
+    // Ids of the unloaded region get reused while it is on disk
+    auto others = CreateEntitiesArray(ecs, 10);
+    for(EntityId ent : others)
+        ecs.AddComponent<Position>(ent, -1.0, -1.0);
+
+    EntityRemap remap;
+    streamer.Load(1, path, [&](const EntityRemap& loaded){ remap = loaded; });
+    EXPECT_GT(syncUntil(RegionState::Resident, 0), 1) << "Merge was not spread over several syncs";
+    ASSERT_EQ(streamer.GetState(1), RegionState::Resident);
+    EXPECT_FALSE(streamer.Busy());
+    EXPECT_EQ(ecs.Stats().aliveEntities, 59u) << "Members that left came back as empty entities";
+    EXPECT_EQ(ecs.Stats().systems[0].entities, 59u);
+    EXPECT_EQ(ecs.Stats().systems[1].entities, 10u);
+
+    const EntityId root = remap(entities[0]);
+    ASSERT_NE(root, INVALID_ID);
+    EXPECT_EQ(remap(entities[40]), INVALID_ID);
+    EXPECT_EQ(remap(entities[28]), INVALID_ID);
+    EXPECT_EQ(remap(entities[29]), INVALID_ID);
+    EXPECT_EQ(ecs.GetComponent<Target>(root).entity, INVALID_ID) << "Handle outside the region was kept";
+    for(EntityId i = 0; i < 28; i++)
+    {
+        const EntityId ent = remap(entities[i]);
+        ASSERT_NE(ent, INVALID_ID);
+        EXPECT_DOUBLE_EQ(ecs.GetComponent<Position>(ent).x, double(i));
+        EXPECT_EQ(ecs.GetComponent<Region>(ent).id, 1u);
+        EXPECT_EQ(ecs.TryGetComponent<Rotation>(ent).has_value(), i % 3 == 0);
+        if(i % 3 == 0)
+        {
+            EXPECT_DOUBLE_EQ(ecs.GetComponent<Rotation>(ent).deg, 10.0 * i);
+        }
+        if(i > 0)
+        {
+            EXPECT_EQ(ecs.GetParent(ent), root);
+            EXPECT_EQ(ecs.GetComponent<Target>(ent).entity, remap(entities[i - 1]));
+        }
+    }
+
+    RegionStreamer other;
+    other.Unload(ecs, 5, path + ".empty");
+    while(other.Busy())
+        other.Sync(ecs, 1000);
+    EXPECT_EQ(other.GetState(5), RegionState::Unloaded);
+    // Valid header claiming far more entities and columns than the file holds
+    std::vector<char> header(std::filesystem::file_size(path));
+    std::ifstream(path, std::ios::binary).read(header.data(), header.size());
+    std::fill(header.begin() + 12, header.begin() + 20, char(0xff));
+    std::ofstream(path + ".huge", std::ios::binary).write(header.data(), 64);
+
+    std::filesystem::resize_file(path, 40);
+    other.Load(1, path);
+    other.Load(2, path + ".missing");
+    other.Load(3, path + ".huge");
+    other.Load(4, std::filesystem::temp_directory_path().string());
+    while(other.Busy())
+        other.Sync(ecs, 1000);
+    EXPECT_EQ(other.GetState(1), RegionState::Failed) << "Truncated file was accepted";
+    EXPECT_EQ(other.GetState(2), RegionState::Failed);
+    EXPECT_EQ(other.GetState(3), RegionState::Failed) << "Sizes in the header were trusted";
+    EXPECT_EQ(other.GetState(4), RegionState::Failed) << "A directory was read as a region";
+    EXPECT_EQ(ecs.Stats().aliveEntities, 59u);
+    std::filesystem::remove(path + ".empty");
+    std::filesystem::remove(path + ".huge");
+    std::filesystem::remove(path);
+}
+
+TEST_F(ECSTest, SharedMemoryExport)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Rotation>();
+    auto entities = CreateEntitiesArray(ecs, 3000);
+    for(EntityId ent : entities)
+        ecs.AddComponent<Position>(ent, double(ent), 1.0);
+    ecs.DestroyEntity(entities[5]);
+
+    const std::string name = "/ecs_test_" + std::to_string(getpid());
+    SharedMemoryExporter exporter;
+    ASSERT_TRUE(exporter.Export<Position>(ecs, name));
+    EXPECT_TRUE(exporter.Publish(ecs));
+
+    SharedColumnReader<Position> reader(name);
+    ASSERT_TRUE(reader.Valid());
+    EXPECT_FALSE(SharedColumnReader<Rotation>(name).Valid()) << "Column opened as the wrong type";
+    EXPECT_FALSE(SharedColumnReader<Position>(name + "_missing").Valid());
+
+    std::vector<EntityId> ids;
+    std::vector<Position> positions;
+    uint64_t frame = 0;
+    ASSERT_TRUE(reader.Snapshot(ids, positions, frame));
+    EXPECT_EQ(frame, 1u);
+    ASSERT_EQ(ids.size(), 2999u);
+    for(size_t i = 0; i < ids.size(); i++)
+        EXPECT_DOUBLE_EQ(positions[i].x, double(ids[i]));
+    EXPECT_TRUE(std::find(ids.begin(), ids.end(), entities[5]) == ids.end());
+
+    {
+        SharedMemoryExporter small;
+        ASSERT_TRUE(small.Export<Position>(ecs, name + "_small", 1000));
+        EXPECT_FALSE(small.Publish(ecs)) << "Overflow was not reported";
+        ASSERT_TRUE(SharedColumnReader<Position>(name + "_small").Snapshot(ids, positions, frame));
+        ASSERT_EQ(ids.size(), 1000u);
+        for(size_t i = 0; i < ids.size(); i++)
+            EXPECT_DOUBLE_EQ(positions[i].x, double(ids[i]));
+    }
+
+    // Another process reads while this one keeps publishing. Every frame writes
+    // the frame number into all components, a torn read would mix two of them.
+    const pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if(child == 0)
+    {
+        SharedColumnReader<Position> childReader(name);
+        uint64_t lastFrame = 0;
+        int exitCode = childReader.Valid() ? 0 : 2;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while(exitCode == 0 && lastFrame < 200 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::vector<EntityId> childIds;
+            std::vector<Position> childPositions;
+            uint64_t childFrame = 0;
+            if(!childReader.Snapshot(childIds, childPositions, childFrame))
+                continue;
+            for(const Position& pos : childPositions)
+                if(pos.y != double(childFrame))
+                    exitCode = 1;
+            if(childFrame < lastFrame || childIds.size() != 2999)
+                exitCode = 3;
+            lastFrame = childFrame;
+        }
+        _exit(exitCode == 0 && lastFrame < 200 ? 4 : exitCode);
+    }
+
+    int status = 0;
+    while(waitpid(child, &status, WNOHANG) == 0)
+    {
+        ecs.GetComponentPool<Position>().ForEach([&](EntityId, Position& pos){ pos.y = double(exporter.Frame() + 1); });
+        exporter.Publish(ecs);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0) << "1 torn frame, 2 no segment, 3 frames went back, 4 too few frames";
+}
+
+TEST_F(ECSTest, RegionStreamingShutdown)
+{
+    ECS ecs;
+    ecs.RegisterComponentPool<Position>();
+    ecs.RegisterComponentPool<Region>();
+    auto entities = CreateEntitiesArray(ecs, 40);
+    for(EntityId i = 0; i < 40; i++)
+    {
+        ecs.AddComponent<Position>(entities[i], double(i), 0.0);
+        ecs.AddComponent<Region>(entities[i], i < 20 ? 1u : 2u);
+    }
+
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string first = (dir / "ecs_region_shutdown_1.bin").string();
+    const std::string second = (dir / "ecs_region_shutdown_2.bin").string();
+    {
+        // Region 1 is fully gathered and queued, region 2 only partly gathered
+        RegionStreamer streamer;
+        streamer.Track<Position>();
+        streamer.Unload(ecs, 1, first);
+        while(streamer.GetState(1) == RegionState::Unloading)
+            streamer.Sync(ecs, 1000000);
+        streamer.Unload(ecs, 2, second);
+        streamer.Sync(ecs, 0);
+        EXPECT_EQ(ecs.Stats().aliveEntities, 19u);
+    }
+
+    RegionStreamer streamer;
+    streamer.Track<Position>();
+    streamer.Load(1, first);
+    streamer.Load(2, second);
+    while(streamer.Busy())
+        streamer.Sync(ecs, 1000);
+    EXPECT_EQ(streamer.GetState(1), RegionState::Resident) << "Queued write was dropped at shutdown";
+    EXPECT_EQ(streamer.GetState(2), RegionState::Resident) << "Partly gathered region was dropped at shutdown";
+    EXPECT_EQ(ecs.Stats().aliveEntities, 40u);
+    double sum = 0.0;
+    ecs.GetComponentPool<Position>().ForEach([&](EntityId, Position& pos){ sum += pos.x; });
+    EXPECT_DOUBLE_EQ(sum, 39.0 * 40.0 / 2.0);
+    std::filesystem::remove(first);
+    std::filesystem::remove(second);
+}
+
 class ComponentManagerTest : public testing::Test
 {
     protected:
@@ -598,3 +1659,237 @@ TEST_F(ComponentManagerTest, CreateComponentWithArgs)
         EXPECT_DOUBLE_EQ(compM.GetComponent<Position>(ent).y, 7);
     }
 }
+
+class HierarchyTest : public testing::Test
+{
+protected:
+    void ExpectValidOrder(const Hierarchy& hierarchy)
+    {
+        const auto& nodes = hierarchy.Nodes();
+        for(uint32_t i = 0; i < nodes.size(); i++)
+        {
+            EXPECT_EQ(hierarchy.IndexOf(nodes[i].entity), i);
+            if(i > 0)
+            {
+                EXPECT_LE(nodes[i - 1].depth, nodes[i].depth) << "Nodes are not sorted by depth";
+            }
+
+            if(nodes[i].parent == INVALID_ID)
+            {
+                EXPECT_EQ(nodes[i].depth, 0u);
+                EXPECT_EQ(nodes[i].parentIndex, INVALID_ID);
+            }
+            else
+            {
+                ASSERT_LT(nodes[i].parentIndex, i) << "Parent does not precede its child";
+                EXPECT_EQ(nodes[nodes[i].parentIndex].entity, nodes[i].parent);
+                EXPECT_EQ(nodes[nodes[i].parentIndex].depth + 1, nodes[i].depth);
+            }
+        }
+    }
+};
+
+TEST_F(HierarchyTest, Reparenting)
+{
+    Hierarchy hierarchy;
+    hierarchy.SetParent(1, 0);
+    hierarchy.SetParent(2, 1);
+    hierarchy.SetParent(3, 2);
+    hierarchy.SetParent(4, 0);
+    hierarchy.SetParent(5, 4);
+    ExpectValidOrder(hierarchy);
+    EXPECT_EQ(hierarchy.GetDepth(3), 3u);
+
+    EXPECT_ANY_THROW(hierarchy.SetParent(0, 3)) << "Created a cycle";
+    EXPECT_ANY_THROW(hierarchy.SetParent(1, 1)) << "Entity became its own parent";
+
+    hierarchy.SetParent(2, 5);
+    ExpectValidOrder(hierarchy);
+    EXPECT_EQ(hierarchy.GetDepth(2), 3u);
+    EXPECT_EQ(hierarchy.GetDepth(3), 4u);
+
+    hierarchy.RemoveParent(4);
+    ExpectValidOrder(hierarchy);
+    EXPECT_EQ(hierarchy.GetDepth(3), 3u);
+
+    int children = 0;
+    hierarchy.ForEachChild(0, [&](EntityId child){ children++; EXPECT_EQ(child, 1u); });
+    EXPECT_EQ(children, 1);
+
+    for(EntityId id = 10; id < 300; id++)
+        hierarchy.SetParent(id, (id * 7919) % (id - 1));
+    for(EntityId id = 10; id < 300; id += 3)
+        hierarchy.SetParent(id, (id * 31) % 10);
+    ExpectValidOrder(hierarchy);
+}
+
+TEST_F(HierarchyTest, DestroyingParent)
+{
+    ECS ecs;
+    auto parent = ecs.CreateEntity();
+    auto child = ecs.CreateEntity();
+    auto grandChild = ecs.CreateEntity();
+    ecs.SetParent(child, parent);
+    ecs.SetParent(grandChild, child);
+    EXPECT_EQ(ecs.GetParent(grandChild), child);
+
+    ecs.DestroyEntity(child);
+    EXPECT_EQ(ecs.GetParent(grandChild), INVALID_ID) << "Child of destroyed entity kept its parent";
+    EXPECT_FALSE(ecs.GetHierarchy().Contains(child));
+    EXPECT_EQ(ecs.GetHierarchy().Nodes().size(), 2u);
+    ExpectValidOrder(ecs.GetHierarchy());
+}
+
+TEST_F(HierarchyTest, Scaling)
+{
+    // Deep chains hung off random earlier nodes, as in the ecs_stress hierarchy scenario.
+    // Timing lives in BM_HierarchyBuildReparent, this only checks the order stays valid.
+    constexpr uint32_t NODES = 50000;
+    constexpr uint32_t MAX_DEPTH = 64;
+    std::mt19937 rng(7);
+    Hierarchy hierarchy;
+    for(EntityId id = 1; id < NODES; id++)
+        hierarchy.SetParent(id, id % MAX_DEPTH != 0 ? id - 1 : rng() % id);
+    for(int i = 0; i < 2000; i++)
+    {
+        const EntityId child = 1 + rng() % (NODES - 1);
+        hierarchy.SetParent(child, rng() % child);
+    }
+    EXPECT_EQ(hierarchy.Nodes().size(), NODES);
+
+    for(EntityId id = 1; id < NODES; id += 7)
+        hierarchy.RemoveParent(id);
+    for(EntityId id = 3; id < NODES; id += 11)
+        hierarchy.Remove(id);
+    ExpectValidOrder(hierarchy);
+
+    // Mixed edits between reads, each read only re-sorts from the shallowest edit
+    Hierarchy small;
+    for(int i = 0; i < 3000; i++)
+    {
+        const EntityId child = 1 + rng() % 199;
+        if(i % 5 == 0 && small.Contains(child))
+            small.Remove(child);
+        else if(i % 7 == 0 && small.Contains(child))
+            small.RemoveParent(child);
+        else
+            small.SetParent(child, rng() % child);
+        if(i % 10 == 0)
+            ExpectValidOrder(small);
+    }
+    ExpectValidOrder(small);
+}
+
+TEST(ProfilerTest, RingBufferAndChromeTrace)
+{
+    Profiler profiler(4);
+    profiler.SetSystemName(0, typeid(HierarchyTest).name());
+    for(int frame = 0; frame < 6; frame++)
+    {
+        profiler.BeginFrame();
+        ProfileScope scope(profiler, 0, ProfilePhase::Update, 42);
+        Profiler::CountStructuralChange();
+    }
+
+    EXPECT_EQ(profiler.FrameCount(), 6u);
+    ASSERT_EQ(profiler.StoredFrames(), 4u) << "Ring buffer kept more frames than its capacity";
+    EXPECT_EQ(profiler.GetFrame(0).frame, 2u) << "Oldest frame was not overwritten";
+    ASSERT_EQ(profiler.GetFrame(3).systems.size(), 1u);
+    EXPECT_EQ(profiler.GetFrame(3).systems[0].entities, 42u);
+    EXPECT_EQ(profiler.GetFrame(3).systems[0].structuralChanges, 1u);
+
+    std::ostringstream trace;
+    profiler.WriteChromeTrace(trace);
+    EXPECT_NE(trace.str().find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(trace.str().find("\"name\":\"HierarchyTest\""), std::string::npos) << "System name was not demangled";
+    EXPECT_EQ(trace.str().find("Frame 1\""), std::string::npos) << "Overwritten frame was exported";
+}
+
+class WorldTest : public testing::Test
+{
+    protected:
+    struct Position
+    {
+        double x = 0.0;
+        double y = 0.0;
+    };
+
+    struct Velocity
+    {
+        double x = 0.0;
+        double y = 0.0;
+    };
+
+    struct Health
+    {
+        int value = 100;
+    };
+
+    class MoveSys : public StaticSystem<Position, Velocity>
+    {
+    public:
+        template <typename World>
+        void Update(World& world, float deltaTime)
+        {
+            for(EntityId ent : entities)
+            {
+                auto& pos = world.template GetComponent<Position>(ent);
+                const auto& vel = world.template GetComponent<Velocity>(ent);
+                pos.x += vel.x * deltaTime;
+                pos.y += vel.y * deltaTime;
+            }
+        }
+    };
+
+    class HealthSys : public StaticSystem<Health>
+    {
+    public:
+        template <typename World>
+        void Render(World&)
+        {
+            rendered = entities.size();
+        }
+
+        uint32_t rendered = 0;
+    };
+
+    using TestWorld = World<ComponentList<Position, Velocity, Health>, SystemList<MoveSys, HealthSys>>;
+};
+
+TEST_F(WorldTest, MatchesECSBehaviour)
+{
+    static_assert(TestWorld::CompId<Health>() == 2);
+
+    auto world = std::make_unique<TestWorld>();
+    world->RegisterComponentPool<Health>(2);
+    std::array<EntityId, 3> entities;
+    for(auto& ent : entities)
+    {
+        ent = world->CreateEntity();
+        world->AddComponent<Position>(ent, 1.0, 1.0);
+    }
+    world->AddComponent<Velocity>(entities[0], 2.0, 0.0);
+    world->AddComponent<Velocity>(entities[1], 0.0, 3.0);
+    world->AddComponent<Health>(entities[1]);
+    world->AddComponent<Health>(entities[2], 50);
+    EXPECT_ANY_THROW(world->AddComponent<Health>(entities[0])) << "Custom pool size was ignored";
+    EXPECT_EQ(world->GetSystem<MoveSys>().Entities().size(), 2u);
+
+    world->UpdateSystems(0.5f);
+    world->RenderSystems();
+    EXPECT_DOUBLE_EQ(world->GetComponent<Position>(entities[0]).x, 2.0);
+    EXPECT_DOUBLE_EQ(world->GetComponent<Position>(entities[1]).y, 2.5);
+    EXPECT_DOUBLE_EQ(world->GetComponent<Position>(entities[2]).x, 1.0);
+    EXPECT_EQ(world->GetSystem<HealthSys>().rendered, 2u);
+
+    world->DeleteComponent<Velocity>(entities[0]);
+    EXPECT_FALSE(world->TryGetComponent<Velocity>(entities[0]));
+    EXPECT_EQ(world->GetSystem<MoveSys>().Entities().size(), 1u);
+
+    world->DestroyEntity(entities[1]);
+    EXPECT_EQ(world->AliveEntities(), 2u);
+    EXPECT_EQ(world->GetSystem<MoveSys>().Entities().size(), 0u);
+    EXPECT_EQ(world->GetSystem<HealthSys>().Entities().size(), 1u);
+    EXPECT_EQ(world->GetComponentPool<Health>().Size(), 1u);
+    EXPECT_EQ(world->CreateEntity(), entities[1]) << "Destroyed id was not recycled";
+}